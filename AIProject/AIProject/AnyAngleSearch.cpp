@@ -0,0 +1,230 @@
+#ifndef ANYANGLESEARCH_CPP
+#define ANYANGLESEARCH_CPP
+#include "AnyAngleSearch.h"
+
+#include <climits>
+#include <cmath>
+
+void WallBitmap::Reset(int width, int height) {
+	this->width = width;
+	this->height = height;
+	wordsPerRow = (width + 63) / 64;
+	bits.assign(wordsPerRow * height, 0ULL);
+}
+
+void WallBitmap::SetBlocked(int x, int y, bool blocked) {
+	if (x < 0 || x >= width || y < 0 || y >= height)
+		return;
+
+	unsigned long long &word = bits[y * wordsPerRow + (x >> 6)];
+	if (blocked)
+		word |= 1ULL << (x & 63);
+	else
+		word &= ~(1ULL << (x & 63));
+}
+
+int WallBitmap::GetGridX() const {
+	return width;
+}
+
+int WallBitmap::GetGridY() const {
+	return height;
+}
+
+bool WallBitmap::IsWalkable(int x, int y) const {
+	return !IsBlocked(x, y);
+}
+
+bool WallBitmap::IsRowClear(int y, int x1, int x2) const {
+	if (x1 > x2)
+		std::swap(x1, x2);
+	if (y < 0 || y >= height || x1 < 0 || x2 >= width)
+		return false;
+
+	//Test whole words at a time, masking off the bits outside the range in the first and last word
+	const unsigned long long *row = &bits[y * wordsPerRow];
+	for (int word = x1 >> 6;word <= (x2 >> 6);word++) {
+		unsigned long long mask = ~0ULL;
+		if (word == (x1 >> 6))
+			mask &= ~0ULL << (x1 & 63);
+		if (word == (x2 >> 6) && (x2 & 63) != 63)
+			mask &= (1ULL << ((x2 & 63) + 1)) - 1;
+
+		if (row[word] & mask)
+			return false;
+	}
+
+	return true;
+}
+
+bool WallBitmap::HasLineOfSight(int x1, int y1, int x2, int y2) const {
+	if (y1 == y2)
+		return IsRowClear(y1, x1, x2);
+
+	//Walk every cell the segment between the two centres passes through
+	int dx = abs(x2 - x1);
+	int dy = abs(y2 - y1);
+	int stepX = (x2 > x1) ? 1 : -1;
+	int stepY = (y2 > y1) ? 1 : -1;
+	int error = dx - dy;
+	int x = x1;
+	int y = y1;
+
+	for (int remaining = dx + dy;;) {
+		if (IsBlocked(x, y))
+			return false;
+		if (remaining <= 0)
+			return true;
+
+		if (error > 0) {
+			x += stepX;
+			error -= 2 * dy;
+			remaining--;
+		} else if (error < 0) {
+			y += stepY;
+			error += 2 * dx;
+			remaining--;
+		} else {
+			//Exactly through a corner. Like a diagonal step, it may not brush past a blocked cell on either side
+			if (IsBlocked(x + stepX, y) || IsBlocked(x, y + stepY))
+				return false;
+
+			x += stepX;
+			y += stepY;
+			error += 2 * (dx - dy);
+			remaining -= 2;
+		}
+	}
+}
+
+//Euclidean distance between two cell centres, in thousandths of a cell
+static int GetStepCost(int x1, int y1, int x2, int y2) {
+	return (int)(sqrt((double)((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1))) * 1000.0 + 0.5);
+}
+
+std::vector<Cell> LazyThetaStarSearch(const WallBitmap &walls, int startX, int startY, int goalX, int goalY, SearchScratch &scratch) {
+	std::vector<Cell> path;
+	int width = walls.GetGridX();
+	int height = walls.GetGridY();
+
+	if (startX < 0 || startX >= width || startY < 0 || startY >= height || goalX < 0 || goalX >= width || goalY < 0 || goalY >= height)
+		return path;
+
+	scratch.Begin(width * height);
+
+	int startIndex = startX + startY * width;
+	int goalIndex = goalX + goalY * width;
+
+	//The start is its own parent, so every other cell's parent chain ends there
+	scratch.See(startIndex, 0, startIndex);
+	scratch.open.push_back(((long long)GetStepCost(startX, startY, goalX, goalY) << 32) | startIndex);
+
+	const int offsetX[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+	const int offsetY[8] = { 0, -1, 0, 1, -1, -1, 1, 1 };
+
+	while (!scratch.open.empty()) {
+		std::pop_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		int current = (int)(scratch.open.back() & 0xFFFFFFFF);
+		scratch.open.pop_back();
+
+		if (scratch.IsClosed(current))
+			continue;
+
+		int currentX = current % width;
+		int currentY = current / width;
+
+		//The lazy part: check the line of sight assumed when this cell was generated, and fall back to the best expanded neighbour if it isn't there
+		int parent = scratch.parent[current];
+		if (current != startIndex && !walls.HasLineOfSight(parent % width, parent / width, currentX, currentY)) {
+			int bestCost = INT_MAX;
+			int bestParent = parent;
+			for (int direction = 0;direction < 8;direction++) {
+				int x = currentX + offsetX[direction];
+				int y = currentY + offsetY[direction];
+				int index = x + y * width;
+				if (x < 0 || x >= width || y < 0 || y >= height || !scratch.IsClosed(index))
+					continue;
+				if (direction >= 4 && (walls.IsBlocked(x, currentY) || walls.IsBlocked(currentX, y)))
+					continue;
+
+				int cost = scratch.g[index] + GetStepCost(x, y, currentX, currentY);
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestParent = index;
+				}
+			}
+
+			scratch.See(current, bestCost, bestParent);
+		}
+
+		scratch.Close(current);
+		scratch.expandedCells++;
+
+		if (current == goalIndex) {
+			//Walk the parents back to the start, then put them in start-to-goal order
+			for (int index = goalIndex;index != startIndex;index = scratch.parent[index])
+				path.push_back(Cell(index % width, index / width));
+
+			if (path.empty())
+				path.push_back(Cell(startX, startY));
+
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+		parent = scratch.parent[current];
+		int parentX = parent % width;
+		int parentY = parent / width;
+
+		for (int direction = 0;direction < 8;direction++) {
+			int x = currentX + offsetX[direction];
+			int y = currentY + offsetY[direction];
+			if (x < 0 || x >= width || y < 0 || y >= height)
+				continue;
+
+			int index = x + y * width;
+			if (scratch.IsClosed(index) || (index != goalIndex && walls.IsBlocked(x, y)))
+				continue;
+			if (direction >= 4 && (walls.IsBlocked(x, currentY) || walls.IsBlocked(currentX, y)))
+				continue; //No cutting corners
+
+			//Assume the parent can see the new cell, it gets checked if this cell is ever expanded
+			int cost = scratch.g[parent] + GetStepCost(parentX, parentY, x, y);
+			if (scratch.IsSeen(index) && scratch.g[index] <= cost)
+				continue;
+
+			scratch.See(index, cost, parent);
+			long long f = cost + GetStepCost(x, y, goalX, goalY);
+			scratch.open.push_back((f << 32) | index);
+			std::push_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		}
+	}
+
+	return path;
+}
+
+std::vector<Cell> StringPullPath(const WallBitmap &walls, Cell start, const std::vector<Cell> &path) {
+	std::vector<Cell> pulled;
+	if (path.size() <= 1)
+		return path;
+
+	Cell anchor = start;
+	for (int x = 0;x < path.size();x++) {
+		if (walls.HasLineOfSight(anchor.x, anchor.y, path[x].x, path[x].y))
+			continue;
+
+		//The anchor can't see this cell, so the previous one is a turning point. If that is the anchor itself, keep this cell
+		Cell turn = (x > 0 && (path[x - 1].x != anchor.x || path[x - 1].y != anchor.y)) ? path[x - 1] : path[x];
+		pulled.push_back(Cell(turn.x, turn.y));
+		anchor = turn;
+
+		if (turn.x != path[x].x || turn.y != path[x].y)
+			x--; //Look at this cell again from the new anchor
+	}
+
+	if (pulled.empty() || pulled.back().x != path.back().x || pulled.back().y != path.back().y)
+		pulled.push_back(Cell(path.back().x, path.back().y));
+
+	return pulled;
+}
+#endif
@@ -0,0 +1,47 @@
+#ifndef CANCELLATIONTOKEN_CPP
+#define CANCELLATIONTOKEN_CPP
+#include "CancellationToken.h"
+
+#include <limits.h>
+
+CancellationToken::CancellationToken() {
+	cancelled = false;
+	deadlineTicks = LLONG_MAX;
+}
+
+void CancellationToken::Cancel() {
+	cancelled.store(true, std::memory_order_relaxed);
+}
+
+void CancellationToken::SetTimeout(std::chrono::steady_clock::duration timeout) {
+	SetDeadline(std::chrono::steady_clock::now() + timeout);
+}
+
+void CancellationToken::SetDeadline(std::chrono::steady_clock::time_point deadline) {
+	deadlineTicks.store(deadline.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+bool CancellationToken::IsCancelled() const {
+	return cancelled.load(std::memory_order_relaxed);
+}
+
+bool CancellationToken::HasTimedOut() const {
+	long long deadline = deadlineTicks.load(std::memory_order_relaxed);
+	if (deadline == LLONG_MAX)
+		return false;
+
+	return std::chrono::steady_clock::now().time_since_epoch().count() >= deadline;
+}
+
+bool CancellationToken::ShouldStop() const {
+	return IsCancelled() || HasTimedOut();
+}
+
+bool CancellationToken::ShouldStop(int expandedCells) const {
+	//The flag is a relaxed load, the clock is only worth reading once every 256 expansions
+	if (cancelled.load(std::memory_order_relaxed))
+		return true;
+
+	return (expandedCells & 255) == 0 && HasTimedOut();
+}
+#endif
@@ -0,0 +1,28 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <atomic>
+#include <chrono>
+
+/*
+Lets a caller abandon a search that is already running, either explicitly or after a timeout.
+Shared between the caller and the search, usually through a std::shared_ptr.
+*/
+class CancellationToken {
+public:
+	CancellationToken(); /* Creates a token that is not cancelled and never times out */
+
+	void Cancel(); /* Requests that the search stops as soon as possible */
+	void SetTimeout(std::chrono::steady_clock::duration timeout); /* The search stops once timeout has passed from now */
+	void SetDeadline(std::chrono::steady_clock::time_point deadline); /* The search stops once deadline has passed */
+
+	bool IsCancelled() const; /* Returns true if Cancel was called */
+	bool HasTimedOut() const; /* Returns true if the deadline has passed. Reads the clock */
+	bool ShouldStop() const; /* Returns true if cancelled or timed out. Reads the clock */
+	bool ShouldStop(int expandedCells) const; /* Cheap check for expansion loops, only reads the clock every 256 expansions */
+private:
+	std::atomic<bool> cancelled; /* Set by Cancel */
+	std::atomic<long long> deadlineTicks; /* steady_clock ticks of the deadline, or LLONG_MAX for none */
+};
+
+#endif
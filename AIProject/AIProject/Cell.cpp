@@ -16,4 +16,16 @@ Cell::Cell(int x, int y) {
 int Cell::GetF() {
 	return g + h;
 }
+
+CellEdit::CellEdit() {
+	this->x = 0;
+	this->y = 0;
+	this->tile = Tile::floor;
+}
+
+CellEdit::CellEdit(int x, int y, Tile tile) {
+	this->x = x;
+	this->y = y;
+	this->tile = tile;
+}
 #endif
\ No newline at end of file
@@ -0,0 +1,138 @@
+#ifndef CLEARANCEMAP_CPP
+#define CLEARANCEMAP_CPP
+#include "ClearanceMap.h"
+
+#include <algorithm>
+
+AgentClearanceView::AgentClearanceView(const ClearanceMap &clearance, int radius) : clearance(clearance) {
+	this->radius = radius;
+}
+
+int AgentClearanceView::GetGridX() const {
+	return clearance.GetGridX();
+}
+
+int AgentClearanceView::GetGridY() const {
+	return clearance.GetGridY();
+}
+
+bool AgentClearanceView::IsWalkable(int x, int y) const {
+	return clearance.CanFit(x, y, radius);
+}
+
+ClearanceMap::ClearanceMap(Grid &grid) : ClearanceMap(grid, defaultMaxClearance) {
+}
+
+ClearanceMap::ClearanceMap(Grid &grid, int maxClearance) : grid(grid) {
+	this->maxClearance = std::max(1, std::min(maxClearance, 254));
+	Rebuild();
+	listenerId = grid.AddChangeListener([this](const GridChange &change) { OnGridChanged(change); });
+}
+
+ClearanceMap::~ClearanceMap() {
+	grid.RemoveChangeListener(listenerId);
+}
+
+int ClearanceMap::GetClearance(int x, int y) const {
+	return Sample(x, y);
+}
+
+bool ClearanceMap::CanFit(int x, int y, int radius) const {
+	return Sample(x, y) > radius;
+}
+
+AgentClearanceView ClearanceMap::ForAgent(int radius) const {
+	return AgentClearanceView(*this, radius);
+}
+
+int ClearanceMap::GetGridX() const {
+	return width;
+}
+
+int ClearanceMap::GetGridY() const {
+	return height;
+}
+
+int ClearanceMap::GetMaxClearance() const {
+	return maxClearance;
+}
+
+int ClearanceMap::GetRecomputedCells() const {
+	return recomputedCells;
+}
+
+void ClearanceMap::Rebuild() {
+	width = grid.GetGridX();
+	height = grid.GetGridY();
+	clearance.assign(width * height, 0);
+	Recompute(0, 0, width - 1, height - 1);
+}
+
+void ClearanceMap::OnGridChanged(const GridChange &change) {
+	if (change.type == GridChangeType::resized || grid.GetGridX() != width || grid.GetGridY() != height) {
+		Rebuild();
+		return;
+	}
+
+	if (change.type != GridChangeType::tiles)
+		return; //Start and goal markers don't block anything
+
+	//A tile can only change the clearance of cells within maxClearance of it, one more ring keeps the window's border exact
+	int margin = maxClearance + 1;
+	Recompute(change.x1 - margin, change.y1 - margin, change.x2 + margin, change.y2 + margin);
+}
+
+void ClearanceMap::Recompute(int x1, int y1, int x2, int y2) {
+	x1 = std::max(x1, 0);
+	y1 = std::max(y1, 0);
+	x2 = std::min(x2, width - 1);
+	y2 = std::min(y2, height - 1);
+	if (x1 > x2 || y1 > y2) {
+		recomputedCells = 0;
+		return;
+	}
+
+	recomputedCells = (x2 - x1 + 1) * (y2 - y1 + 1);
+
+	//Walls are sources, everything else starts as far away as we care about
+	for (int y = y1;y <= y2;y++) {
+		unsigned char *row = &clearance[y * width];
+		for (int x = x1;x <= x2;x++)
+			row[x] = grid.IsWalkable(x, y) ? (unsigned char)maxClearance : 0;
+	}
+
+	//Two-pass chessboard distance transform. The forward pass pulls from the left and the row above,
+	//the backward pass from the right and the row below. Cells just outside the window are already
+	//exact and act as extra sources, which is what lets an edit recompute only its neighbourhood.
+	for (int y = y1;y <= y2;y++) {
+		unsigned char *row = &clearance[y * width];
+		for (int x = x1;x <= x2;x++) {
+			if (row[x] == 0)
+				continue;
+
+			int best = std::min(std::min(Sample(x - 1, y), Sample(x - 1, y - 1)), std::min(Sample(x, y - 1), Sample(x + 1, y - 1))) + 1;
+			if (best < row[x])
+				row[x] = (unsigned char)best;
+		}
+	}
+
+	for (int y = y2;y >= y1;y--) {
+		unsigned char *row = &clearance[y * width];
+		for (int x = x2;x >= x1;x--) {
+			if (row[x] == 0)
+				continue;
+
+			int best = std::min(std::min(Sample(x + 1, y), Sample(x + 1, y + 1)), std::min(Sample(x, y + 1), Sample(x - 1, y + 1))) + 1;
+			if (best < row[x])
+				row[x] = (unsigned char)best;
+		}
+	}
+}
+
+int ClearanceMap::Sample(int x, int y) const {
+	if (x < 0 || x >= width || y < 0 || y >= height) //Outside of the grid is treated like the outer walls
+		return 0;
+
+	return clearance[x + y * width];
+}
+#endif
@@ -0,0 +1,132 @@
+#ifndef DISTANCEMATRIX_H
+#define DISTANCEMATRIX_H
+
+#include "Cell.h"
+#include "Isochrone.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/* A dense rows x columns matrix of path lengths, -1 where there is no path */
+class DistanceMatrix {
+public:
+	void Reset(int rows, int columns); /* Resizes the matrix and marks every entry unreachable */
+
+	int Get(int row, int column) const { return values[row * columns + column]; } /* Moves from source row to target column, -1 if unreachable */
+	void Set(int row, int column, int distance) { values[row * columns + column] = distance; }
+	int *GetRow(int row) { return &values[row * columns]; } /* The row's columns entries, contiguous */
+
+	int GetRows() const;
+	int GetColumns() const;
+	const std::vector<int> &GetValues() const; /* Row-major, row * GetColumns() + column */
+private:
+	int rows = 0;
+	int columns = 0;
+	std::vector<int> values;
+};
+
+/*
+Fills matrix with the path length from every source (rows) to every target (columns) over 4-directional moves.
+Works on any map providing int GetGridX() const, int GetGridY() const and bool IsWalkable(int x, int y) const.
+
+Runs one breadth-first search per source instead of one search per pair. Sources are spread over threadCount
+threads (0 uses the hardware thread count), each thread reuses one ReachableRegion as its scratch and writes
+straight into its sources' rows. With stopWhenSettled, a source's search ends as soon as every target has its
+distance, otherwise it floods everything the source can reach.
+Targets can always be entered, like Grid's goal, but targets on walls are not walked through.
+*/
+template <typename Map>
+void MapDistanceMatrix(const Map &map, const std::vector<Cell> &sources, const std::vector<Cell> &targets, DistanceMatrix &matrix, int threadCount, bool stopWhenSettled) {
+	int width = map.GetGridX();
+	int height = map.GetGridY();
+	matrix.Reset((int)sources.size(), (int)targets.size());
+
+	//Index the targets by cell, chaining targets that share a cell, so a search finds a cell's columns in O(1)
+	std::vector<int> firstTarget = std::vector<int>(width * height, -1);
+	std::vector<int> nextTarget = std::vector<int>(targets.size(), -1);
+	int targetCells = 0;
+	for (int x = 0;x < targets.size();x++) {
+		if (targets[x].x < 0 || targets[x].x >= width || targets[x].y < 0 || targets[x].y >= height)
+			continue;
+
+		int index = targets[x].x + targets[x].y * width;
+		if (firstTarget[index] == -1)
+			targetCells++;
+
+		nextTarget[x] = firstTarget[index];
+		firstTarget[index] = x;
+	}
+
+	if (targetCells == 0)
+		return; //Nothing to measure, every entry stays unreachable
+
+	if (threadCount <= 0)
+		threadCount = (int)std::thread::hardware_concurrency();
+	if (threadCount > (int)sources.size())
+		threadCount = (int)sources.size();
+
+	const int offsetX[4] = { -1, 0, 1, 0 };
+	const int offsetY[4] = { 0, -1, 0, 1 };
+
+	std::atomic<int> nextSource{ 0 };
+	auto work = [&]() {
+		ReachableRegion region; //One scratch per thread, reused for all of its sources
+
+		for (int source = nextSource++;source < (int)sources.size();source = nextSource++) {
+			int sourceX = sources[source].x;
+			int sourceY = sources[source].y;
+			region.Begin(width, height, -1);
+			if (sourceX < 0 || sourceX >= width || sourceY < 0 || sourceY >= height)
+				continue;
+
+			int *row = matrix.GetRow(source);
+			int settled = 0;
+			int sourceIndex = sourceX + sourceY * width;
+			region.Reach(sourceIndex, 0);
+
+			//BFS discovers each cell at its final distance, so a target is settled the moment it's reached
+			for (int head = 0;head < region.GetReachedCount();head++) {
+				int current = region.GetReachedCells()[head];
+				int distance = region.GetDistanceIndex(current);
+
+				if (firstTarget[current] != -1) {
+					for (int target = firstTarget[current];target != -1;target = nextTarget[target])
+						row[target] = distance;
+
+					settled++;
+					if (stopWhenSettled && settled == targetCells)
+						break;
+				}
+
+				int currentX = current % width;
+				int currentY = current / width;
+				if (current != sourceIndex && !map.IsWalkable(currentX, currentY))
+					continue; //A target on a wall can be reached but not walked through
+
+				for (int direction = 0;direction < 4;direction++) {
+					int x = currentX + offsetX[direction];
+					int y = currentY + offsetY[direction];
+					if (x < 0 || x >= width || y < 0 || y >= height)
+						continue;
+
+					int index = x + y * width;
+					if (region.IsReachedIndex(index) || (firstTarget[index] == -1 && !map.IsWalkable(x, y)))
+						continue;
+
+					region.Reach(index, distance + 1);
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int x = 1;x < threadCount;x++)
+		threads.push_back(std::thread(work));
+
+	work(); //The calling thread takes a share too
+	for (int x = 0;x < threads.size();x++)
+		threads[x].join();
+}
+
+#endif
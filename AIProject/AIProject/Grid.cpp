@@ -1,6 +1,8 @@
 #ifndef GRID_CPP
 #define GRID_CPP
 #include "Grid.h"
+#include "Heuristics.h"
+#include "SearchEngine.h"
 
 Grid::Grid() {
 	ResizeGrid(10);
@@ -25,25 +27,18 @@ void Grid::ResizeGrid(int x, int y) {
 	gridSizeX = x;
 	gridSizeY = y;
 
-	//Clear and resize the vectors to the appropriate length
-	grid.clear();
-	grid.resize(x);
+	//Clear and resize the arrays to the appropriate length. Everything starts as a wall, layout padding stays that way
+	AllocateStorage();
 
-	for (int i = 0; i < x; i++) {
-		//Resize the child vectors to the appropriate lengths
-		grid[i].resize(y);
-
-		for (int j = 0; j < y; j++) {
-			//Fill the cells with new Cell classes, with correct positioning
-			grid[i][j] = Cell(i, j);
-
-			//For aesthetics, make all the cells on the outter edge a wall
-			if (i == 0 || i == x - 1 || j == 0 || j == y - 1)
-				SetCell(i, j, Tile::wall);
-			else
-				SetCell(i, j, Tile::floor);
-		}
+	//For aesthetics, leave all the cells on the outter edge a wall
+	for (int i = 1; i < x - 1; i++) {
+		for (int j = 1; j < y - 1; j++)
+			cells[GetIndex(i, j)] = EncodeTile(Tile::floor);
 	}
+
+	//Every cell is new, so everything is dirty and one resize event replaces per-cell ones
+	dirtyTiles.assign((size_t)x * y, 1);
+	changes.Publish(GridChange(GridChangeType::resized, 0, 0, x - 1, y - 1));
 }
 
 void Grid::SetRandomStartGoal() {
@@ -57,61 +52,218 @@ void Grid::SetRandomStartGoal() {
 	}
 
 	//Make sure the tiles know they're start and end positions
-	grid[startPos.x][startPos.y].startCell = true;
-	grid[goalPos.x][goalPos.y].goalCell = true;
+	cells[GetIndex(startPos.x, startPos.y)] |= startFlag;
+	cells[GetIndex(goalPos.x, goalPos.y)] |= goalFlag;
+
+	MarkDirty(startPos.x, startPos.y);
+	MarkDirty(goalPos.x, goalPos.y);
+	changes.BeginBatch();
+	changes.Publish(GridChange(GridChangeType::markers, startPos.x, startPos.y, startPos.x, startPos.y));
+	changes.Publish(GridChange(GridChangeType::markers, goalPos.x, goalPos.y, goalPos.x, goalPos.y));
+	changes.EndBatch();
 }
 
 bool Grid::SetCell(int x, int y, Tile tile) {
-	if (x<0 || x>gridSizeX || y<0 || y>gridSizeY) //If cell is outside of boundaries, don't set it
+	if (x<0 || x>=gridSizeX || y<0 || y>=gridSizeY) //If cell is outside of boundaries, don't set it
 		return false;
 
-	grid[x][y].tileType = tile;
+	//Setting a tile to what it already is changes nothing, so nobody needs to hear about it
+	unsigned char &cell = cells[GetIndex(x, y)];
+	if ((cell & tileBits) == EncodeTile(tile))
+		return true;
+
+	cell = (unsigned char)((cell & ~tileBits) | EncodeTile(tile));
+	MarkDirty(x, y);
+	changes.Publish(GridChange(GridChangeType::tiles, x, y, x, y));
 
 	return true;
 }
 
 bool Grid::SetCell(Cell cell, Tile tile) {
-	if (cell.x<0 || cell.x>gridSizeX || cell.y<0 || cell.y>gridSizeY) //If cell is outside of boundaries, don't set it
-		return false;
+	return SetCell(cell.x, cell.y, cell.tileType);
+}
 
-	grid[cell.x][cell.y].tileType = cell.tileType;
+int Grid::FillRect(int x1, int y1, int x2, int y2, Tile tile) {
+	//Clip once up front instead of bounds checking every cell
+	int left = std::max(std::min(x1, x2), 0);
+	int right = std::min(std::max(x1, x2), gridSizeX - 1);
+	int top = std::max(std::min(y1, y2), 0);
+	int bottom = std::min(std::max(y1, y2), gridSizeY - 1);
+	if (left > right || top > bottom)
+		return 0;
+
+	EditBounds bounds;
+	unsigned char code = EncodeTile(tile);
+	for (int y = top;y <= bottom;y++) {
+		if (layout != GridLayout::linear) {
+			for (int x = left;x <= right;x++)
+				WriteTile(x, y, tile, bounds);
+			continue;
+		}
 
-	return true;
+		//A linear row is contiguous in both cells and dirtyTiles. Trim the cells that already hold the tile off either end
+		unsigned char *row = &cells[(size_t)y * gridSizeX];
+		unsigned char *dirtyRow = &dirtyTiles[(size_t)y * gridSizeX];
+		int first = left;
+		while (first <= right && (row[first] & tileBits) == code)
+			first++;
+		if (first > right)
+			continue;
+
+		int last = right;
+		while ((row[last] & tileBits) == code)
+			last--;
+
+		//Then one branch-free pass over the rest, which vectorises. The flags share each byte, so the tile bits are masked in rather than memset
+		for (int x = first;x <= last;x++) {
+			dirtyRow[x] |= (unsigned char)((row[x] & tileBits) != code);
+			row[x] = (unsigned char)((row[x] & ~tileBits) | code);
+		}
+		bounds.Add(first, y);
+		bounds.Add(last, y);
+	}
+
+	PublishEdits(bounds);
+	return (right - left + 1) * (bottom - top + 1);
+}
+
+int Grid::ApplyMask(int x, int y, int width, int height, const std::vector<unsigned char> &mask, Tile tile) {
+	if (width <= 0 || height <= 0 || (long long)mask.size() < (long long)width * height)
+		return 0;
+
+	//Only walk the part of the mask that lands on the grid
+	int left = std::max(x, 0);
+	int right = std::min(x + width - 1, gridSizeX - 1);
+	int top = std::max(y, 0);
+	int bottom = std::min(y + height - 1, gridSizeY - 1);
+
+	int applied = 0;
+	EditBounds bounds;
+	for (int j = top;j <= bottom;j++) {
+		for (int i = left;i <= right;i++) {
+			if (mask[(i - x) + (j - y) * width] != 0) {
+				WriteTile(i, j, tile, bounds);
+				applied++;
+			}
+		}
+	}
+
+	PublishEdits(bounds);
+	return applied;
+}
+
+int Grid::ApplyStamp(int x, int y, int width, int height, const std::vector<Tile> &tiles) {
+	if (width <= 0 || height <= 0 || (long long)tiles.size() < (long long)width * height)
+		return 0;
+
+	int left = std::max(x, 0);
+	int right = std::min(x + width - 1, gridSizeX - 1);
+	int top = std::max(y, 0);
+	int bottom = std::min(y + height - 1, gridSizeY - 1);
+	if (left > right || top > bottom)
+		return 0;
+
+	EditBounds bounds;
+	for (int j = top;j <= bottom;j++) {
+		for (int i = left;i <= right;i++)
+			WriteTile(i, j, tiles[(i - x) + (j - y) * width], bounds);
+	}
+
+	PublishEdits(bounds);
+	return (right - left + 1) * (bottom - top + 1);
+}
+
+int Grid::ApplyEdits(const std::vector<CellEdit> &edits) {
+	int applied = 0;
+	EditBounds bounds;
+	for (int x = 0;x < edits.size();x++) {
+		if (edits[x].x < 0 || edits[x].x >= gridSizeX || edits[x].y < 0 || edits[x].y >= gridSizeY)
+			continue;
+
+		WriteTile(edits[x].x, edits[x].y, edits[x].tile, bounds);
+		applied++;
+	}
+
+	PublishEdits(bounds);
+	return applied;
 }
 
 Cell Grid::GetCell(int x, int y) {
-	if (x<0 || x>gridSizeX || y<0 || y>gridSizeY) //If cell is outside of boundaries, return a null cell
+	if (x<0 || x>=gridSizeX || y<0 || y>=gridSizeY) //If cell is outside of boundaries, return a null cell
 		return Cell();
 
-	return grid[x][y];
+	return ReadCell(x, y);
 }
 
 Cell Grid::GetCell(Cell cell) {
-	if (cell.x<0 || cell.x>gridSizeX || cell.y<0 || cell.y>gridSizeY) //If cell is outside of boundaries, return a null cell
-		return Cell();
-
-	return grid[cell.x][cell.y];
+	return GetCell(cell.x, cell.y);
 }
 
-int Grid::GetGridX() {
+int Grid::GetGridX() const {
 	return gridSizeX;
 }
 
-int Grid::GetGridY() {
+int Grid::GetGridY() const {
 	return gridSizeY;
 }
 
+void Grid::SetLayout(GridLayout layout) {
+	if (this->layout == layout)
+		return;
+
+	//Read every cell out in the old layout, then write it back in the new one. Parents belong to finished searches and can go
+	std::vector<unsigned char> contents = std::vector<unsigned char>((size_t)gridSizeX * gridSizeY);
+	for (int y = 0;y < gridSizeY;y++) {
+		for (int x = 0;x < gridSizeX;x++)
+			contents[x + (size_t)y * gridSizeX] = cells[GetIndex(x, y)];
+	}
+
+	this->layout = layout;
+	AllocateStorage();
+	for (int y = 0;y < gridSizeY;y++) {
+		for (int x = 0;x < gridSizeX;x++)
+			cells[GetIndex(x, y)] = contents[x + (size_t)y * gridSizeX];
+	}
+}
+
+GridLayout Grid::GetLayout() const {
+	return layout;
+}
+
+size_t Grid::GetStorageSize() const {
+	return cells.size();
+}
+
+size_t Grid::GetStorageIndex(int x, int y) const {
+	return (size_t)GetIndex(x, y);
+}
+
+bool Grid::IsWalkable(int x, int y) const {
+	if (x < 0 || x >= gridSizeX || y < 0 || y >= gridSizeY)
+		return false;
+
+	return (cells[GetIndex(x, y)] & tileBits) == EncodeTile(Tile::floor);
+}
+
 Cell Grid::GetGoalPos() {
 	return goalPos;
 }
 
 void Grid::SetGoalPos(int x, int y) {
-	if (x<0 || x>gridSizeX || y<0 || y>gridSizeY)
+	if (x<0 || x>=gridSizeX || y<0 || y>=gridSizeY)
 		return;
 
-	grid[goalPos.x][goalPos.y].goalCell = false;
-	goalPos = grid[x][y];
-	grid[x][y].goalCell = true;
+	int oldX = goalPos.x;
+	int oldY = goalPos.y;
+
+	cells[GetIndex(goalPos.x, goalPos.y)] &= ~goalFlag;
+	goalPos = ReadCell(x, y);
+	cells[GetIndex(x, y)] |= goalFlag;
+
+	//Both the cell that lost the marker and the one that gained it need redrawing
+	MarkDirty(oldX, oldY);
+	MarkDirty(x, y);
+	changes.Publish(GridChange(GridChangeType::markers, oldX, oldY, x, y));
 }
 
 Cell Grid::GetStartPos() {
@@ -119,383 +271,325 @@ Cell Grid::GetStartPos() {
 }
 
 void Grid::SetStartPos(int x, int y) {
-	if (x<0 || x>gridSizeX || y<0 || y>gridSizeY)
+	if (x<0 || x>=gridSizeX || y<0 || y>=gridSizeY)
 		return;
 
-	grid[startPos.x][startPos.y].startCell = false;
-	startPos = grid[x][y];
-	grid[x][y].startCell = true;
+	int oldX = startPos.x;
+	int oldY = startPos.y;
+
+	cells[GetIndex(startPos.x, startPos.y)] &= ~startFlag;
+	startPos = ReadCell(x, y);
+	cells[GetIndex(x, y)] |= startFlag;
+
+	//Both the cell that lost the marker and the one that gained it need redrawing
+	MarkDirty(oldX, oldY);
+	MarkDirty(x, y);
+	changes.Publish(GridChange(GridChangeType::markers, oldX, oldY, x, y));
 }
 
 void Grid::OutputGrid() {
 	//If the cell is marked as a goal or start pos, output that character instead of a wall or floor tile
 	for (int y = 0; y < gridSizeY; y++) {
 		for (int x = 0; x < gridSizeX; x++) {
-			std::cout << ((grid[x][y].goalCell) ? (char)Tile::goal : ((grid[x][y].startCell) ? (char)Tile::start : (char)(grid[x][y].tileType)));
+			unsigned char cell = cells[GetIndex(x, y)];
+			std::cout << ((cell & goalFlag) ? (char)Tile::goal : ((cell & startFlag) ? (char)Tile::start : (char)DecodeTile(cell & tileBits)));
 		}
 		std::cout << std::endl;
 	}
 }
 
-std::vector<Cell> Grid::GetValidNeighbors(int x, int y) {
-	std::vector<Cell> neighbors = std::vector<Cell>();
+bool Grid::LoadGrid(std::istream &in) {
+	int width = 0;
+	int height = 0;
+	if (!(in >> width >> height) || width < 3 || height < 3)
+		return false;
 
-	//Check all directions to make sure they are in bounds, and either a floor tile or a goal tile.
-	//Then return the vector, populated or not
-	if (x - 1 >= 0 && (grid[x - 1][y].tileType == Tile::floor || grid[x - 1][y].goalCell)) {
-		neighbors.push_back(grid[x - 1][y]);
-	}
-	if (y - 1 >= 0 && (grid[x][y - 1].tileType == Tile::floor || grid[x][y - 1].goalCell)) {
-		neighbors.push_back(grid[x][y - 1]);
-	}
-	if (x + 1 < gridSizeX && (grid[x + 1][y].tileType == Tile::floor || grid[x + 1][y].goalCell)) {
-		neighbors.push_back(grid[x + 1][y]);
+	BeginEdits(); //Listeners hear about the whole load at once
+	ResizeGrid(width, height);
+	SetRandomStartGoal(); //Make sure start and goal are valid even if the file doesn't mark them
+
+	for (int y = 0; y < height; y++) {
+		std::string row;
+		if (!(in >> row) || (int)row.size() != width) {
+			EndEdits();
+			return false;
+		}
+
+		for (int x = 0; x < width; x++) {
+			switch (row[x]) {
+			case '#':
+				SetCell(x, y, Tile::wall);
+				break;
+			case '.':
+				SetCell(x, y, Tile::floor);
+				break;
+			case 'S':
+				SetCell(x, y, Tile::floor);
+				SetStartPos(x, y);
+				break;
+			case 'G':
+				SetCell(x, y, Tile::floor);
+				SetGoalPos(x, y);
+				break;
+			default: //Unknown tile character
+				EndEdits();
+				return false;
+			}
+		}
 	}
-	if (y + 1 < gridSizeY && (grid[x][y + 1].tileType == Tile::floor || grid[x][y + 1].goalCell)) {
-		neighbors.push_back(grid[x][y + 1]);
+
+	EndEdits();
+	return true;
+}
+
+void Grid::SaveGrid(std::ostream &out) {
+	out << gridSizeX << " " << gridSizeY << "\n";
+
+	for (int y = 0; y < gridSizeY; y++) {
+		for (int x = 0; x < gridSizeX; x++) {
+			unsigned char cell = cells[GetIndex(x, y)];
+			out << ((cell & goalFlag) ? 'G' : ((cell & startFlag) ? 'S' : ((DecodeTile(cell & tileBits) == Tile::wall) ? '#' : '.')));
+		}
+		out << "\n";
 	}
+}
 
+std::vector<Cell> Grid::GetValidNeighbors(int x, int y) {
+	std::vector<Cell> neighbors = std::vector<Cell>();
+	ForEachValidNeighbor(x, y, [&](int neighborX, int neighborY) { neighbors.push_back(ReadCell(neighborX, neighborY)); });
 	return neighbors;
 }
 
+int Grid::GetValidNeighbors(int x, int y, int neighbors[4]) const {
+	int count = 0;
+	ForEachValidNeighbor(x, y, [&](int neighborX, int neighborY) { neighbors[count++] = neighborX + neighborY * gridSizeX; });
+	return count;
+}
+
 double Grid::GetManhattanDistance(int x1, int y1, int x2, int y2) {
-	if ((x1 < 0 || x1 >= gridSizeX || x2 < 0 || x2 >= gridSizeX) || (y1<0 || y1>gridSizeY || y2<0 || y2>gridSizeY))
+	if (x1 < 0 || x1 >= gridSizeX || x2 < 0 || x2 >= gridSizeX || y1 < 0 || y1 >= gridSizeY || y2 < 0 || y2 >= gridSizeY)
 		return -1;
 
-	return abs(x1 - x2) + (y1 - y2);
+	return ManhattanDistance(x1, y1, x2, y2);
 }
 
 double Grid::GetEuclidianDistance(int x1, int y1, int x2, int y2) {
-	if ((x1 < 0 || x1 >= gridSizeX || x2 < 0 || x2 >= gridSizeX) || (y1<0 || y1>gridSizeY || y2<0 || y2>gridSizeY))
+	if (x1 < 0 || x1 >= gridSizeX || x2 < 0 || x2 >= gridSizeX || y1 < 0 || y1 >= gridSizeY || y2 < 0 || y2 >= gridSizeY)
 		return -1;
 
-	return sqrt(pow(abs(x2 - x1), 2) + pow(abs(y2 - y1), 2));
+	return sqrt((double)((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1)));
 }
 
 std::vector<Cell> Grid::DepthFirstSearch() {
-	//Fringe serves as the fringe, path is the path to return later
-	std::stack<Cell> fringe = std::stack<Cell>();
-	std::vector<Cell> path = std::vector<Cell>();
-
-	fringe.push(startPos); //Push the startPos onto the fringe
-
-	int totalTraversedCells = 0;
-
-	//Loop until we have no other possible ways to move
-	while (!fringe.empty()) {
-		Cell current = grid[fringe.top().x][fringe.top().y]; //Make a copy of the current cell
-
-		//If this cell has already been visited, remove it from the fringe and continue
-		if (current.visited) {
-			fringe.pop();
-			continue;
-		}
-
-		grid[current.x][current.y].visited = true; //Mark this cell as visited
-		totalTraversedCells++;
-
-		fringe.pop(); //Remove the current cell from the fringe
-
-		//If we have found the goal, we need to return the path
-		if (current.goalCell) {
-			if (displayAllTraversedCells)
-				std::cout << "(" << current.x << ", " << current.y << ")[Goal]";
-
-			std::cout << "\n\nTotal Visited Cells: " << totalTraversedCells;
-
-			//If the parent cell is a nullptr, the current cell is also the start position. Simply return the current cell as the path.
-			//Otherwise, compile a vector of the path's trail back to the start, and reverse it
-			if (current.parentCell == nullptr) {
-				path.push_back(current);
-				ResetCellSearchSettings(); //Reset all grid cells to be not-visited and have no-parent-pointers.
-				return path;
-			} else {
-				Cell inwards = grid[goalPos.x][goalPos.y]; //the current cell moving backwards
-
-				//Continue on while the parent cell is not a nullptr
-				while (inwards.parentCell!=nullptr) {
-					path.push_back(inwards);
-					inwards = *inwards.parentCell;
-				}
-
-				std::reverse(path.begin(), path.end()); //make sure the vector is in the right order
-
-				ResetCellSearchSettings(); //Reset all grid cells to be not-visited and have no-parent-pointers.
-				return path;
-			}
-		}
-
-		if (displayAllTraversedCells)
-			std::cout << "(" << current.x << ", " << current.y << ") -> ";
-
-		std::vector<Cell> neighbors = GetValidNeighbors(current.x, current.y); //Obtain the neighbors that are valid
-
-		for (int x = 0;x < neighbors.size();x++) {
-			//If we haven't visited the cell, set the parent cell to this cell, and push it onto the stack
-			if (neighbors[x].visited == false) {
-				grid[neighbors[x].x][neighbors[x].y].parentCell = &grid[current.x][current.y];
-				fringe.push(neighbors[x]);
-			}
-		}
-	}
-
-	std::cout << "\n\nTotal Visited Cells: " << totalTraversedCells;
-	ResetCellSearchSettings(); //Reset all grid cells to be not-visited and have no-parent-pointers.
-	return path;
+	return DepthFirstEngine::Run(*this);
 }
 
 std::vector<Cell> Grid::BreadthFirstSearch() {
-	//Fringe serves as the fringe, path is the path to return later
-	std::queue<Cell> fringe = std::queue<Cell>();
-	std::vector<Cell> path = std::vector<Cell>();
-
-	fringe.push(startPos); //push the start position onto the fringe
-
-	int totalTraversedCells = 0;
-
-	//Loop until we have no other possible ways to move
-	while (!fringe.empty()) {
-		Cell current = grid[fringe.front().x][fringe.front().y]; //Make a copy of the current cell
-
-		 //If this cell has already been visited, remove it from the fringe and continue
-		if (current.visited) {
-			fringe.pop();
-			continue;
-		}
-
-		grid[current.x][current.y].visited = true; //Mark this cell as visited
-		totalTraversedCells++;
-
-		fringe.pop(); //Remove the current cell from the fringe
-
-		if (current.goalCell) {
-			if (displayAllTraversedCells)
-				std::cout << "(" << current.x << ", " << current.y << ")[Goal]";
-
-			std::cout << "\n\nTotal Visited Cells: " << totalTraversedCells;
-
-			//If the parent cell is a nullptr, the current cell is also the start position. Simply return the current cell as the path.
-			//Otherwise, compile a vector of the path's trail back to the start, and reverse it
-			if (current.parentCell == nullptr) {
-				path.push_back(current);
-				ResetCellSearchSettings(); //Reset all grid cells to be not-visited and have no-parent-pointers.
-				return path;
-			} else {
-				Cell inwards = grid[goalPos.x][goalPos.y]; //the current cell moving backwards
+	return BreadthFirstEngine::Run(*this);
+}
 
-				//Continue on while the parent cell is not a nullptr
-				while (inwards.parentCell != nullptr) {
-					path.push_back(inwards);
-					inwards = *inwards.parentCell;
-				}
+std::vector<Cell> Grid::GreedySearch() {
+	return GreedyEngine::Run(*this);
+}
 
-				std::reverse(path.begin(), path.end()); //make sure the vector is in the right order
+std::vector<Cell> Grid::AStarSearch() {
+	return AStarEngine::Run(*this);
+}
 
-				ResetCellSearchSettings(); //Reset all grid cells to be not-visited and have no-parent-pointers.
-				return path;
-			}
-		}
+std::vector<Cell> Grid::Search(SearchAlgorithm algorithm) {
+	switch (algorithm) {
+	case SearchAlgorithm::depthFirst:
+		return DepthFirstSearch();
+	case SearchAlgorithm::breadthFirst:
+		return BreadthFirstSearch();
+	case SearchAlgorithm::greedy:
+		return GreedySearch();
+	case SearchAlgorithm::aStar:
+		return AStarSearch();
+	default:
+		return std::vector<Cell>();
+	}
+}
 
-		if(displayAllTraversedCells)
-			std::cout << "(" << current.x << ", " << current.y << ") -> ";
+bool Grid::Search(SearchAlgorithm algorithm, std::vector<unsigned int> &path) {
+	IndexPathSink sink(path, gridSizeX);
+	switch (algorithm) {
+	case SearchAlgorithm::depthFirst:
+		return DepthFirstEngine::Run(*this, sink);
+	case SearchAlgorithm::breadthFirst:
+		return BreadthFirstEngine::Run(*this, sink);
+	case SearchAlgorithm::greedy:
+		return GreedyEngine::Run(*this, sink);
+	case SearchAlgorithm::aStar:
+		return AStarEngine::Run(*this, sink);
+	default:
+		return false;
+	}
+}
 
-		std::vector<Cell> neighbors = GetValidNeighbors(current.x, current.y); //Obtain the neighbors that are valid
+/* Reset all cells in the grid to be unvisited */
+void Grid::ResetCellSearchSettings() {
+	for (size_t x = 0;x < cells.size();x++)
+		cells[x] &= ~visitedFlag;
+}
 
-		for (int x = 0;x < neighbors.size();x++) {
-			if (neighbors[x].visited == false) {
-				//If we haven't visited the cell, set the parent cell to this cell, and push it onto the stack
-				grid[neighbors[x].x][neighbors[x].y].parentCell = &grid[current.x][current.y];
-				fringe.push(neighbors[x]);
+void Grid::PepperWalls() {
+	std::vector<CellEdit> walls;
+	for (int x = 1;x < gridSizeX - 1;x++) {
+		for (int y = 1;y < gridSizeY - 1;y++) {
+			if ((rand() % 100) < 25) {
+				walls.push_back(CellEdit(x, y, Tile::wall));
 			}
 		}
 	}
 
-	std::cout << "\n\nTotal Visited Cells: " << totalTraversedCells;
-	ResetCellSearchSettings(); //Reset all grid cells to be not-visited and have no-parent-pointers.
-	return path;
+	//Walled border, clear inside, then the random walls, published as one change
+	BeginEdits();
+	FillRect(0, 0, gridSizeX - 1, gridSizeY - 1, Tile::wall);
+	FillRect(1, 1, gridSizeX - 2, gridSizeY - 2, Tile::floor);
+	ApplyEdits(walls);
+	EndEdits();
 }
 
-std::vector<Cell> Grid::GreedySearch() {
-	std::vector<Cell> path;
-	std::vector<Cell> greedyStack;
-	greedyStack.push_back(startPos);
-
-	int totalTraversedCells = 0;
-
-	while (greedyStack.size() > 0) {
-		//Find the lowest h value of the list
-		int currentPos = 0;
-		for (int x = 1;x < greedyStack.size();x++) {
-			if (grid[greedyStack[currentPos].x][greedyStack[currentPos].y].h >= grid[greedyStack[x].x][greedyStack[x].y].h)
-				currentPos = x;
-		}
-
-		Cell current = grid[greedyStack[currentPos].x][greedyStack[currentPos].y];
-		greedyStack.erase(greedyStack.begin() + currentPos);
-
-		if (current.visited)
-			continue;
-
-		grid[current.x][current.y].visited = true;
-		totalTraversedCells++;
+void Grid::SetDisplayAllTraversedCells(bool flag) {
+	displayAllTraversedCells = flag;
+}
 
-		if (current.goalCell) {
-			if (displayAllTraversedCells)
-				std::cout << "(" << current.x << ", " << current.y << ")[Goal]";
+bool Grid::GetDisplayAllTraversedCells() {
+	return displayAllTraversedCells;
+}
 
-			std::cout << "\n\nTotal Visited Cells: " << totalTraversedCells;
+void Grid::SetOutputSearchDiagnostics(bool flag) {
+	outputSearchDiagnostics = flag;
+}
 
-			//If the parent cell is a nullptr, the current cell is also the start position. Simply return the current cell as the path.
-			//Otherwise, compile a vector of the path's trail back to the start, and reverse it
-			if (current.parentCell == nullptr) {
-				path.push_back(current);
-				ResetCellSearchSettings(); //Reset all grid cells to be not-visited and have no-parent-pointers.
-				return path;
-			} else {
-				Cell inwards = grid[goalPos.x][goalPos.y]; //the current cell moving backwards
+bool Grid::GetOutputSearchDiagnostics() {
+	return outputSearchDiagnostics;
+}
 
-				//Continue on while the parent cell is not a nullptr
-				while (inwards.parentCell != nullptr) {
-					path.push_back(inwards);
-					inwards = *inwards.parentCell;
-				}
+void Grid::SetCancellationToken(const CancellationToken *token) {
+	cancellationToken = token;
+}
 
-				std::reverse(path.begin(), path.end()); //make sure the vector is in the right order
+bool Grid::WasLastSearchCancelled() {
+	return lastSearchCancelled;
+}
 
-				ResetCellSearchSettings(); //Reset all grid cells to be not-visited and have no-parent-pointers.
-				return path;
-			}
-		}
+unsigned long long Grid::GetVersion() {
+	return changes.GetVersion();
+}
 
-		if (displayAllTraversedCells)
-			std::cout << "(" << current.x << ", " << current.y << ") -> ";
-
-		std::vector<Cell> neighbors = GetValidNeighbors(current.x, current.y);
-		//std::cout << neighbors.size() << std::endl;
-		for (int x = 0;x < neighbors.size();x++) {
-			if (neighbors[x].visited == false) {
-				//If we haven't visited the cell, set the parent cell to this cell, and push it onto the stack
-				grid[neighbors[x].x][neighbors[x].y].parentCell = &grid[current.x][current.y];
-				grid[neighbors[x].x][neighbors[x].y].h = GetEuclidianDistance(neighbors[x].x, neighbors[x].y, goalPos.x, goalPos.y);
-				greedyStack.push_back(grid[neighbors[x].x][neighbors[x].y]);
-			}
-		}
-	}
+bool Grid::IsDirty(int x, int y) {
+	if (x < 0 || x >= gridSizeX || y < 0 || y >= gridSizeY)
+		return false;
 
-	std::cout << "\n\nTotal Visited Cells: " << totalTraversedCells;
-	ResetCellSearchSettings(); //Reset all grid cells to be not-visited and have no-parent-pointers.
-	return path;
+	long long index = x + (long long)y * gridSizeX;
+	return dirtyTiles[index] != 0;
 }
 
-std::vector<Cell> Grid::AStarSearch() {
-	std::vector<Cell> path;
-	std::vector<Cell> starStack;
-	starStack.push_back(startPos);
-
-	int totalTraversedCells = 0;
-
-	while (starStack.size() > 0) {
-		//Find the lowest f value of the list
-		int currentPos = 0;
-		for (int x = 1;x < starStack.size();x++) {
-			if (grid[starStack[currentPos].x][starStack[currentPos].y].GetF() > grid[starStack[x].x][starStack[x].y].GetF())
-				currentPos = x;
-		}
-
-		Cell current = grid[starStack[currentPos].x][starStack[currentPos].y];
-		starStack.erase(starStack.begin() + currentPos);
+int Grid::GetDirtyCount() {
+	return (int)std::count(dirtyTiles.begin(), dirtyTiles.end(), (unsigned char)1);
+}
 
-		if (current.visited)
-			continue;
+void Grid::ClearDirty() {
+	std::fill(dirtyTiles.begin(), dirtyTiles.end(), (unsigned char)0);
+}
 
-		grid[current.x][current.y].visited = true;
-		totalTraversedCells++;
+int Grid::AddChangeListener(std::function<void(const GridChange &)> listener) {
+	return changes.AddListener(listener);
+}
 
-		if (current.goalCell) {
-			if (displayAllTraversedCells)
-				std::cout << "(" << current.x << ", " << current.y << ")[Goal]";
+void Grid::RemoveChangeListener(int id) {
+	changes.RemoveListener(id);
+}
 
-			std::cout << "\n\nTotal Visited Cells: " << totalTraversedCells;
+void Grid::BeginEdits() {
+	changes.BeginBatch();
+}
 
-			//If the parent cell is a nullptr, the current cell is also the start position. Simply return the current cell as the path.
-			//Otherwise, compile a vector of the path's trail back to the start, and reverse it
-			if (current.parentCell == nullptr) {
-				path.push_back(current);
-				ResetCellSearchSettings(); //Reset all grid cells to be not-visited and have no-parent-pointers.
-				return path;
-			} else {
-				Cell inwards = grid[goalPos.x][goalPos.y]; //the current cell moving backwards
+void Grid::EndEdits() {
+	changes.EndBatch();
+}
 
-				//Continue on while the parent cell is not a nullptr
-				while (inwards.parentCell != nullptr) {
-					path.push_back(inwards);
-					inwards = *inwards.parentCell;
-				}
+void Grid::MarkDirty(int x, int y) {
+	long long index = x + (long long)y * gridSizeX;
+	dirtyTiles[index] = 1;
+}
 
-				std::reverse(path.begin(), path.end()); //make sure the vector is in the right order
+void Grid::WriteTile(int x, int y, Tile tile, EditBounds &bounds) {
+	unsigned char &cell = cells[GetIndex(x, y)];
+	if ((cell & tileBits) == EncodeTile(tile))
+		return;
 
-				ResetCellSearchSettings(); //Reset all grid cells to be not-visited and have no-parent-pointers.
-				return path;
-			}
-		}
+	cell = (unsigned char)((cell & ~tileBits) | EncodeTile(tile));
+	MarkDirty(x, y);
+	bounds.Add(x, y);
+}
 
-		if (displayAllTraversedCells)
-			std::cout << "(" << current.x << ", " << current.y << ") -> ";
-
-		std::vector<Cell> neighbors = GetValidNeighbors(current.x, current.y);
-		//std::cout << neighbors.size() << std::endl;
-		for (int x = 0;x < neighbors.size();x++) {
-			if (neighbors[x].visited == false) {
-				//If we haven't visited the cell, set the parent cell to this cell, and push it onto the stack
-				grid[neighbors[x].x][neighbors[x].y].parentCell = &grid[current.x][current.y];
-				grid[neighbors[x].x][neighbors[x].y].h = GetEuclidianDistance(neighbors[x].x, neighbors[x].y, goalPos.x, goalPos.y);
-				grid[neighbors[x].x][neighbors[x].y].g = grid[current.x][current.y].g+1;
-				starStack.push_back(grid[neighbors[x].x][neighbors[x].y]);
-			}
-		}
+unsigned char Grid::EncodeTile(Tile tile) {
+	switch (tile) {
+	case Tile::floor:
+		return 0;
+	case Tile::start:
+		return 2;
+	case Tile::goal:
+		return 3;
+	default:
+		return 1;
 	}
+}
 
-	std::cout << "\n\nTotal Visited Cells: " << totalTraversedCells;
-	ResetCellSearchSettings(); //Reset all grid cells to be not-visited and have no-parent-pointers.
-	return path;
+Tile Grid::DecodeTile(unsigned char code) {
+	static const Tile tiles[4] = { Tile::floor, Tile::wall, Tile::start, Tile::goal };
+	return tiles[code & tileBits];
 }
 
-/* Reset all cells in the grid to be unvisited and parentless */
-void Grid::ResetCellSearchSettings() {
-	for (int x = 0;x < gridSizeX;x++) {
-		for (int y = 0;y < gridSizeY;y++) {
-			grid[x][y].visited = false;
-			grid[x][y].parentCell = nullptr;
-			grid[x][y].h = 0;
-			grid[x][y].g = 0;
-		}
+void Grid::AllocateStorage() {
+	size_t count = (size_t)gridSizeX * gridSizeY;
+	if (layout == GridLayout::tiled) {
+		tilesX = (gridSizeX + 7) / 8;
+		count = (size_t)tilesX * ((gridSizeY + 7) / 8) * 64;
+	}
+	else if (layout == GridLayout::morton) {
+		int bitsX = 0;
+		int bitsY = 0;
+		while ((1 << bitsX) < gridSizeX)
+			bitsX++;
+		while ((1 << bitsY) < gridSizeY)
+			bitsY++;
+
+		mortonBits = std::min(bitsX, bitsY);
+		mortonMask = (1 << mortonBits) - 1;
+		count = (size_t)1 << (bitsX + bitsY);
 	}
+
+	cells.assign(count, EncodeTile(Tile::wall));
+	parents.assign((count + 3) / 4, 0);
 }
 
-void Grid::PepperWalls() {
-	for (int x = 0;x < gridSizeX;x++) {
-		for (int y = 0;y < gridSizeY;y++) {
-			if (x == 0 || x == gridSizeX - 1 || y == 0 || y == gridSizeY - 1)
-				SetCell(x, y, Tile::wall);
-			else
-				SetCell(x, y, Tile::floor);
-		}
-	}
+Cell Grid::ReadCell(int x, int y) const {
+	unsigned char cell = cells[GetIndex(x, y)];
 
-	for (int x = 1;x < gridSizeX - 1;x++) {
-		for (int y = 1;y < gridSizeY - 1;y++) {
-			if ((rand() % 100) < 25) {
-				SetCell(x, y, Tile::wall);
-			}
-		}
-	}
+	Cell result = Cell(x, y);
+	result.tileType = DecodeTile(cell & tileBits);
+	result.startCell = (cell & startFlag) != 0;
+	result.goalCell = (cell & goalFlag) != 0;
+	return result;
 }
 
-void Grid::SetDisplayAllTraversedCells(bool flag) {
-	displayAllTraversedCells = flag;
+void Grid::PublishEdits(EditBounds &bounds) {
+	if (!bounds.IsEmpty())
+		changes.Publish(GridChange(GridChangeType::tiles, bounds.x1, bounds.y1, bounds.x2, bounds.y2));
 }
 
-bool Grid::GetDisplayAllTraversedCells() {
-	return displayAllTraversedCells;
+void Grid::EditBounds::Add(int x, int y) {
+	x1 = std::min(x1, x);
+	y1 = std::min(y1, y);
+	x2 = std::max(x2, x);
+	y2 = std::max(y2, y);
+}
+
+bool Grid::EditBounds::IsEmpty() {
+	return x2 < 0;
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef GRIDCHANGE_H
+#define GRIDCHANGE_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/* What kind of change a GridChange describes */
+enum class GridChangeType : char {
+	tiles, /* Tiles inside the rectangle changed */
+	markers, /* The start or goal position moved into or out of the rectangle */
+	resized /* The grid was resized, or rebuilt wholesale. Everything derived from it is stale */
+};
+
+/* One change to a grid: an inclusive rectangle of cells and the grid version it produced */
+class GridChange {
+public:
+	GridChange(); /* An empty tiles change at (0, 0) */
+	GridChange(GridChangeType type, int x1, int y1, int x2, int y2); /* A change covering the inclusive rectangle (x1, y1)-(x2, y2) */
+
+	GridChangeType type;
+	int x1; /* Left edge, inclusive */
+	int y1; /* Top edge, inclusive */
+	int x2; /* Right edge, inclusive */
+	int y2; /* Bottom edge, inclusive */
+	unsigned long long version = 0; /* The grid version after this change. Every change in one batch shares a version */
+};
+
+/*
+The change-event stream of a Grid.
+Outside of a batch each change is published immediately with its own version.
+Inside a batch changes are coalesced into a few rectangles and published together, with one version, when the outermost batch ends.
+
+Copying a feed copies its version but not its listeners or pending changes: a copy of a Grid is a different grid,
+and whoever subscribed to the original did not ask to hear about the copy.
+The feed is thread-safe, since a RegionLockedGrid edits one Grid from several threads. Listeners are called on the editing
+thread without the feed's lock held, and batches are shared by every thread editing the grid.
+With no listener and no open batch, publishing only bumps the atomic version and never takes the lock.
+*/
+class GridChangeFeed {
+public:
+	static const int maxPendingRects = 32; /* Past this many rectangles of one type in a batch, they collapse into their bounding box */
+
+	GridChangeFeed();
+	GridChangeFeed(const GridChangeFeed &other); /* Copies the version only */
+	GridChangeFeed &operator=(const GridChangeFeed &other); /* Copies the version only, keeping this feed's listeners */
+
+	int AddListener(std::function<void(const GridChange &)> listener); /* Returns an id for RemoveListener */
+	void RemoveListener(int id);
+
+	void BeginBatch(); /* Starts coalescing changes. Batches nest */
+	void EndBatch(); /* Publishes the coalesced changes once the outermost batch ends */
+	void Publish(const GridChange &change); /* Publishes change now, or adds it to the current batch */
+
+	unsigned long long GetVersion() const; /* Returns the version of the last published change, 0 if none */
+private:
+	class Listener {
+	public:
+		int id;
+		std::function<void(const GridChange &)> callback;
+	};
+
+	void AddPending(const GridChange &change); /* Merges change into a touching pending rectangle of the same type, or adds it. Needs feedMutex */
+	void Notify(const std::shared_ptr<const std::vector<Listener>> &current, const GridChange &change);
+
+	std::atomic<unsigned long long> version{ 0 };
+	std::atomic<int> batchDepth{ 0 }; /* Only changed under feedMutex, read without it by Publish's fast path */
+	std::atomic<bool> hasListeners{ false }; /* Only changed under feedMutex, read without it by Publish's fast path */
+
+	mutable std::mutex feedMutex; /* Guards everything below */
+
+	int nextListenerId = 1;
+	std::shared_ptr<const std::vector<Listener>> listeners; /* Replaced, never edited, so publishing only copies the pointer. Null when empty */
+	std::vector<GridChange> pending; /* Coalesced changes of the current batch */
+};
+
+#endif
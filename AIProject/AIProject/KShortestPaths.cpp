@@ -0,0 +1,21 @@
+#ifndef KSHORTESTPATHS_CPP
+#define KSHORTESTPATHS_CPP
+#include "KShortestPaths.h"
+
+double GetPathDissimilarity(const std::vector<int> &candidate, const std::vector<int> &other) {
+	if (candidate.empty())
+		return 0.0;
+
+	//Both paths are short next to the grid, so sort a copy rather than keep a cell-sized table around
+	std::vector<int> sortedOther = other;
+	std::sort(sortedOther.begin(), sortedOther.end());
+
+	int shared = 0;
+	for (int x = 0;x < candidate.size();x++) {
+		if (std::binary_search(sortedOther.begin(), sortedOther.end(), candidate[x]))
+			shared++;
+	}
+
+	return 1.0 - (double)shared / candidate.size();
+}
+#endif
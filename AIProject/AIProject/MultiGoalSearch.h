@@ -0,0 +1,177 @@
+#ifndef MULTIGOALSEARCH_H
+#define MULTIGOALSEARCH_H
+
+#include "Cell.h"
+#include "MapSearch.h"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+/*
+A set of goal cells on a width x height map.
+Membership is a bitmap, so checking whether a cell is a goal costs one bit test.
+Goals are also filed into square buckets, a coarse spatial index that finds the nearest goal
+by looking at nearby buckets first and stopping once no further bucket can hold anything closer.
+*/
+class GoalSet {
+public:
+	static const int bucketSize = 16; /* Width and height of a spatial index bucket in cells */
+
+	GoalSet(); /* An empty set on a 0 x 0 map */
+	GoalSet(int width, int height); /* An empty set on a width x height map */
+
+	void Reset(int width, int height); /* Removes every goal and resizes the set */
+	bool Add(int x, int y); /* Adds a goal. Returns false if out of bounds or already a goal */
+
+	bool Contains(int x, int y) const; /* Returns true if (x, y) is a goal */
+	bool ContainsIndex(int index) const { return (bitmap[index >> 6] >> (index & 63)) & 1; } /* Contains by cell index, x + y * width */
+	int GetCount() const; /* Returns the number of goals */
+	const std::vector<Cell> &GetGoals() const; /* Returns every goal, in the order they were added */
+	int GetWidth() const;
+	int GetHeight() const;
+
+	int GetNearestDistance(int x, int y, const std::vector<int> &excluded) const; /* Manhattan distance from (x, y) to the nearest goal whose index isn't in excluded, -1 if there is none */
+private:
+	int width = 0;
+	int height = 0;
+	int bucketsX = 0; /* Buckets per row */
+	int bucketsY = 0; /* Buckets per column */
+	std::vector<unsigned long long> bitmap; /* One bit per cell */
+	std::vector<Cell> goals;
+	std::vector<std::vector<int>> buckets; /* Goal cell indices by bucket, bucket (bx, by) at bx + by * bucketsX */
+};
+
+/* One goal reached by a multi-goal search and the path to it */
+class GoalPath {
+public:
+	Cell goal; /* The goal cell reached */
+	int cost = 0; /* Moves from the start to the goal */
+	std::vector<Cell> path; /* Excludes the start cell, unless the start is the goal */
+};
+
+/*
+Finds the k goals closest to (startX, startY) by path length, and the path to each, in one A* pass.
+Works on any map providing int GetGridX() const, int GetGridY() const and bool IsWalkable(int x, int y) const.
+
+The heuristic is the Manhattan distance to the nearest goal not yet found, which is admissible and consistent.
+Finding a goal can only raise it, so open entries keep their old f as a lower bound
+and are re-keyed lazily when they come up with a larger one.
+Goal cells can always be entered, like Grid's goal, but walls that are goals are not expanded through.
+Results are in order of cost. Fewer than k come back if fewer are reachable.
+*/
+template <typename Map>
+std::vector<GoalPath> MapNearestGoalsSearch(const Map &map, int startX, int startY, const GoalSet &goals, int k, SearchScratch &scratch) {
+	std::vector<GoalPath> results;
+	int width = map.GetGridX();
+	int height = map.GetGridY();
+
+	if (startX < 0 || startX >= width || startY < 0 || startY >= height || k <= 0 || goals.GetWidth() != width || goals.GetHeight() != height)
+		return results;
+
+	scratch.Begin(width * height);
+
+	int startIndex = startX + startY * width;
+	std::vector<int> found; //Goal indices already returned, excluded from the heuristic
+
+	int h = goals.GetNearestDistance(startX, startY, found);
+	if (h < 0)
+		return results;
+
+	scratch.See(startIndex, 0, -1);
+	scratch.open.push_back(((long long)h << 32) | startIndex);
+
+	const int offsetX[4] = { -1, 0, 1, 0 };
+	const int offsetY[4] = { 0, -1, 0, 1 };
+
+	while (!scratch.open.empty()) {
+		std::pop_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		long long entry = scratch.open.back();
+		int current = (int)(entry & 0xFFFFFFFF);
+		scratch.open.pop_back();
+
+		if (scratch.IsClosed(current))
+			continue;
+
+		int currentX = current % width;
+		int currentY = current / width;
+
+		//Goals found since this entry was pushed may have raised its heuristic, if so put it back with the true f
+		if (!goals.ContainsIndex(current)) {
+			h = goals.GetNearestDistance(currentX, currentY, found);
+			if (h < 0)
+				break; //Every goal has been found
+
+			long long f = scratch.g[current] + h;
+			if (f > (entry >> 32)) {
+				scratch.open.push_back((f << 32) | current);
+				std::push_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+				continue;
+			}
+		}
+
+		scratch.Close(current);
+		scratch.expandedCells++;
+
+		if (goals.ContainsIndex(current)) {
+			GoalPath result;
+			result.goal = Cell(currentX, currentY);
+			result.cost = scratch.g[current];
+
+			//Walk the parents back to the start, then put them in start-to-goal order
+			for (int index = current;index != startIndex;index = scratch.parent[index])
+				result.path.push_back(Cell(index % width, index / width));
+
+			if (result.path.empty())
+				result.path.push_back(Cell(startX, startY));
+
+			std::reverse(result.path.begin(), result.path.end());
+			results.push_back(result);
+			found.push_back(current);
+
+			if ((int)results.size() == k || (int)found.size() == goals.GetCount())
+				break;
+
+			if (current != startIndex && !map.IsWalkable(currentX, currentY))
+				continue; //A goal on a wall can be reached but not walked through
+		}
+
+		for (int direction = 0;direction < 4;direction++) {
+			int x = currentX + offsetX[direction];
+			int y = currentY + offsetY[direction];
+			if (x < 0 || x >= width || y < 0 || y >= height)
+				continue;
+
+			int index = x + y * width;
+			if (scratch.IsClosed(index) || (!goals.ContainsIndex(index) && !map.IsWalkable(x, y)))
+				continue;
+
+			int cost = scratch.g[current] + 1;
+			if (scratch.IsSeen(index) && scratch.g[index] <= cost)
+				continue;
+
+			h = goals.GetNearestDistance(x, y, found);
+			if (h < 0)
+				h = 0;
+
+			scratch.See(index, cost, current);
+			long long f = cost + h;
+			scratch.open.push_back((f << 32) | index);
+			std::push_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		}
+	}
+
+	return results;
+}
+
+/* The path to whichever goal is closest to (startX, startY), empty if none can be reached. See MapNearestGoalsSearch */
+template <typename Map>
+std::vector<Cell> MapNearestGoalSearch(const Map &map, int startX, int startY, const GoalSet &goals, SearchScratch &scratch) {
+	std::vector<GoalPath> results = MapNearestGoalsSearch(map, startX, startY, goals, 1, scratch);
+	if (results.empty())
+		return std::vector<Cell>();
+
+	return results[0].path;
+}
+
+#endif
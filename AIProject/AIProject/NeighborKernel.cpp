@@ -0,0 +1,113 @@
+#ifndef NEIGHBORKERNEL_CPP
+#define NEIGHBORKERNEL_CPP
+#include "NeighborKernel.h"
+
+void WalkableMask::Reset(int width, int height) {
+	this->width = width;
+	this->height = height;
+	stride = width + 2;
+
+	cells.assign(stride * (height + 2), 0);
+	for (int y = 0;y < height;y++) {
+		for (int x = 0;x < width;x++)
+			cells[GetIndex(x, y)] = 1;
+	}
+}
+
+void WalkableMask::SetWalkable(int x, int y, bool walkable) {
+	if (x < 0 || x >= width || y < 0 || y >= height)
+		return;
+
+	cells[GetIndex(x, y)] = walkable ? 1 : 0;
+}
+
+int WalkableMask::GetGridX() const {
+	return width;
+}
+
+int WalkableMask::GetGridY() const {
+	return height;
+}
+
+bool WalkableMask::IsWalkable(int x, int y) const {
+	return x >= 0 && x < width && y >= 0 && y < height && cells[GetIndex(x, y)] != 0;
+}
+
+//The A* loop both mask searches share, neighbors is 4 or 8 and picks the kernel at compile time
+template <int neighbors>
+static std::vector<Cell> MaskSearch(const WalkableMask &mask, int startX, int startY, int goalX, int goalY, SearchScratch &scratch) {
+	std::vector<Cell> path;
+	int width = mask.GetGridX();
+	int height = mask.GetGridY();
+	int stride = mask.GetStride();
+
+	if (startX < 0 || startX >= width || startY < 0 || startY >= height || goalX < 0 || goalX >= width || goalY < 0 || goalY >= height)
+		return path;
+
+	scratch.Begin(mask.GetCellCount());
+
+	int startIndex = mask.GetIndex(startX, startY);
+	int goalIndex = mask.GetIndex(goalX, goalY);
+	int startH = neighbors == 4 ? ManhattanDistance(startX, startY, goalX, goalY) : OctileDistance(startX, startY, goalX, goalY, 1000, 1414);
+
+	scratch.See(startIndex, 0, -1);
+	scratch.open.push_back(((long long)startH << 32) | startIndex);
+
+	NeighborBatch batch;
+	while (!scratch.open.empty()) {
+		std::pop_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		int current = (int)(scratch.open.back() & 0xFFFFFFFF);
+		scratch.open.pop_back();
+
+		if (scratch.IsClosed(current))
+			continue;
+
+		scratch.Close(current);
+		scratch.expandedCells++;
+
+		if (current == goalIndex) {
+			//Walk the parents back to the start, then put them in start-to-goal order
+			for (int index = goalIndex;index != startIndex;index = scratch.parent[index])
+				path.push_back(Cell(index % stride - 1, index / stride - 1));
+
+			if (path.empty())
+				path.push_back(Cell(startX, startY));
+
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+		int currentX = current % stride - 1;
+		int currentY = current / stride - 1;
+		if (neighbors == 4)
+			ExpandNeighbors4(mask, current, currentX, currentY, scratch.g[current], goalIndex, goalX, goalY, batch);
+		else
+			ExpandNeighbors8(mask, current, currentX, currentY, scratch.g[current], goalIndex, goalX, goalY, batch);
+
+		//Only the lanes the kernel let through reach the open list
+		for (int lanes = batch.validMask;lanes != 0;lanes &= lanes - 1) {
+			int lane = 0;
+			while (!((lanes >> lane) & 1))
+				lane++;
+
+			int index = batch.index[lane];
+			if (scratch.IsClosed(index) || (scratch.IsSeen(index) && scratch.g[index] <= batch.g[lane]))
+				continue;
+
+			scratch.See(index, batch.g[lane], current);
+			scratch.open.push_back(((long long)batch.f[lane] << 32) | index);
+			std::push_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		}
+	}
+
+	return path;
+}
+
+std::vector<Cell> MaskAStarSearch(const WalkableMask &mask, int startX, int startY, int goalX, int goalY, SearchScratch &scratch) {
+	return MaskSearch<4>(mask, startX, startY, goalX, goalY, scratch);
+}
+
+std::vector<Cell> MaskOctileAStarSearch(const WalkableMask &mask, int startX, int startY, int goalX, int goalY, SearchScratch &scratch) {
+	return MaskSearch<8>(mask, startX, startY, goalX, goalY, scratch);
+}
+#endif
@@ -0,0 +1,176 @@
+#ifndef NEIGHBORKERNEL_H
+#define NEIGHBORKERNEL_H
+
+#include "Cell.h"
+#include "Heuristics.h"
+#include "MapSearch.h"
+
+#include <vector>
+
+//SSE2 is always there on x64, and on x86 when building with /arch:SSE2 (the default) or -msse2. AVX2 needs /arch:AVX2 or -mavx2
+#if !defined(NEIGHBORKERNEL_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define NEIGHBORKERNEL_SSE2
+#include <emmintrin.h>
+#endif
+#if !defined(NEIGHBORKERNEL_SCALAR) && defined(__AVX2__)
+#define NEIGHBORKERNEL_AVX2
+#include <immintrin.h>
+#endif
+
+/*
+One byte per cell, 1 where walkable, with a ring of blocked cells around the map.
+The ring means a neighbor is always index + a fixed offset and never needs a bounds check,
+which is what lets the kernels below load and test all of a cell's neighbors at once.
+Satisfies the map interface itself.
+*/
+class WalkableMask {
+public:
+	void Reset(int width, int height); /* Resizes to width x height with every cell walkable */
+
+	template <typename Map>
+	void Build(const Map &map) { /* Copies the walkability of any map type */
+		Reset(map.GetGridX(), map.GetGridY());
+		for (int y = 0;y < height;y++) {
+			for (int x = 0;x < width;x++)
+				cells[GetIndex(x, y)] = map.IsWalkable(x, y) ? 1 : 0;
+		}
+	}
+
+	void SetWalkable(int x, int y, bool walkable); /* Marks an in-bounds cell walkable or blocked */
+
+	int GetGridX() const;
+	int GetGridY() const;
+	bool IsWalkable(int x, int y) const; /* False outside the map */
+
+	int GetStride() const { return stride; } /* Distance between vertically adjacent cells' indices */
+	int GetIndex(int x, int y) const { return (x + 1) + (y + 1) * stride; } /* Padded index of an in-bounds cell */
+	int GetCellCount() const { return (int)cells.size(); } /* Size of the padded index space */
+	bool IsWalkableIndex(int index) const { return cells[index] != 0; }
+	const unsigned char *GetData() const { return cells.data(); }
+private:
+	int width = 0;
+	int height = 0;
+	int stride = 2;
+	std::vector<unsigned char> cells; /* Row-major with the ring, (x, y) lives at GetIndex(x, y) */
+};
+
+/*
+The successors of one expanded cell. Lane i holds one neighbor's padded index, tentative g and f,
+and bit i of validMask says whether that neighbor can be entered.
+*/
+class NeighborBatch {
+public:
+	int index[8];
+	int g[8];
+	int f[8];
+	int validMask;
+};
+
+/*
+4-connected expansion of the cell at padded index current, which is (x, y) with cost g so far.
+Moves cost 1 and f uses the Manhattan distance to (goalX, goalY). The goal may always be entered.
+Lanes are left, up, right, down. Tile tests, tentative g, h and f for all four run as one SSE2 pass where available.
+*/
+inline void ExpandNeighbors4(const WalkableMask &mask, int current, int x, int y, int g, int goalIndex, int goalX, int goalY, NeighborBatch &batch) {
+	const unsigned char *cells = mask.GetData();
+	int stride = mask.GetStride();
+
+#ifdef NEIGHBORKERNEL_SSE2
+	__m128i index = _mm_add_epi32(_mm_set1_epi32(current), _mm_setr_epi32(-1, -stride, 1, stride));
+	__m128i walk = _mm_setr_epi32(cells[current - 1], cells[current - stride], cells[current + 1], cells[current + stride]);
+	__m128i valid = _mm_or_si128(_mm_cmpgt_epi32(walk, _mm_setzero_si128()), _mm_cmpeq_epi32(index, _mm_set1_epi32(goalIndex)));
+
+	//SSE2 has no 32-bit abs, so use (v ^ sign) - sign
+	__m128i dx = _mm_add_epi32(_mm_set1_epi32(x - goalX), _mm_setr_epi32(-1, 0, 1, 0));
+	__m128i dy = _mm_add_epi32(_mm_set1_epi32(y - goalY), _mm_setr_epi32(0, -1, 0, 1));
+	__m128i signX = _mm_srai_epi32(dx, 31);
+	__m128i signY = _mm_srai_epi32(dy, 31);
+	__m128i h = _mm_add_epi32(_mm_sub_epi32(_mm_xor_si128(dx, signX), signX), _mm_sub_epi32(_mm_xor_si128(dy, signY), signY));
+	__m128i cost = _mm_set1_epi32(g + 1);
+
+	_mm_storeu_si128((__m128i *)batch.index, index);
+	_mm_storeu_si128((__m128i *)batch.g, cost);
+	_mm_storeu_si128((__m128i *)batch.f, _mm_add_epi32(cost, h));
+	batch.validMask = _mm_movemask_ps(_mm_castsi128_ps(valid));
+#else
+	const int offsetX[4] = { -1, 0, 1, 0 };
+	const int offsetY[4] = { 0, -1, 0, 1 };
+	const int offset[4] = { -1, -stride, 1, stride };
+
+	batch.validMask = 0;
+	for (int lane = 0;lane < 4;lane++) {
+		batch.index[lane] = current + offset[lane];
+		batch.g[lane] = g + 1;
+		batch.f[lane] = g + 1 + ManhattanDistance(x + offsetX[lane], y + offsetY[lane], goalX, goalY);
+		batch.validMask |= (cells[batch.index[lane]] != 0 || batch.index[lane] == goalIndex) << lane;
+	}
+#endif
+}
+
+/*
+8-connected expansion, with straight moves costing 1000 and diagonal ones 1414, and f using the octile distance.
+A diagonal move needs both cells it passes between to be walkable, so it never cuts a corner. The goal may always be entered.
+Lanes are left, up, right, down, then up-left, up-right, down-right, down-left. One AVX2 pass where available.
+*/
+inline void ExpandNeighbors8(const WalkableMask &mask, int current, int x, int y, int g, int goalIndex, int goalX, int goalY, NeighborBatch &batch) {
+	const unsigned char *cells = mask.GetData();
+	int stride = mask.GetStride();
+
+#ifdef NEIGHBORKERNEL_AVX2
+	__m256i index = _mm256_add_epi32(_mm256_set1_epi32(current), _mm256_setr_epi32(-1, -stride, 1, stride, -1 - stride, 1 - stride, 1 + stride, -1 + stride));
+	__m256i walk = _mm256_cmpgt_epi32(_mm256_setr_epi32(cells[current - 1], cells[current - stride], cells[current + 1], cells[current + stride],
+		cells[current - 1 - stride], cells[current + 1 - stride], cells[current + 1 + stride], cells[current - 1 + stride]), _mm256_setzero_si256());
+
+	//Each diagonal lane picks up the two straight lanes it squeezes between, straight lanes need no corner
+	__m256i cornerA = _mm256_permutevar8x32_epi32(walk, _mm256_setr_epi32(0, 1, 2, 3, 0, 2, 2, 0));
+	__m256i cornerB = _mm256_permutevar8x32_epi32(walk, _mm256_setr_epi32(0, 1, 2, 3, 1, 1, 3, 3));
+	__m256i corners = _mm256_or_si256(_mm256_and_si256(cornerA, cornerB), _mm256_setr_epi32(-1, -1, -1, -1, 0, 0, 0, 0));
+	__m256i enterable = _mm256_or_si256(walk, _mm256_cmpeq_epi32(index, _mm256_set1_epi32(goalIndex)));
+
+	__m256i dx = _mm256_abs_epi32(_mm256_add_epi32(_mm256_set1_epi32(x - goalX), _mm256_setr_epi32(-1, 0, 1, 0, -1, 1, 1, -1)));
+	__m256i dy = _mm256_abs_epi32(_mm256_add_epi32(_mm256_set1_epi32(y - goalY), _mm256_setr_epi32(0, -1, 0, 1, -1, -1, 1, 1)));
+	__m256i h = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_max_epi32(dx, dy), _mm256_set1_epi32(1000)), _mm256_mullo_epi32(_mm256_min_epi32(dx, dy), _mm256_set1_epi32(414)));
+	__m256i cost = _mm256_add_epi32(_mm256_set1_epi32(g), _mm256_setr_epi32(1000, 1000, 1000, 1000, 1414, 1414, 1414, 1414));
+
+	_mm256_storeu_si256((__m256i *)batch.index, index);
+	_mm256_storeu_si256((__m256i *)batch.g, cost);
+	_mm256_storeu_si256((__m256i *)batch.f, _mm256_add_epi32(cost, h));
+	batch.validMask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(enterable, corners)));
+#else
+	const int offsetX[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+	const int offsetY[8] = { 0, -1, 0, 1, -1, -1, 1, 1 };
+	const int offset[8] = { -1, -stride, 1, stride, -1 - stride, 1 - stride, 1 + stride, -1 + stride };
+	const int cornerA[8] = { 0, 1, 2, 3, 0, 2, 2, 0 };
+	const int cornerB[8] = { 0, 1, 2, 3, 1, 1, 3, 3 };
+
+	int walk = 0;
+	for (int lane = 0;lane < 8;lane++)
+		walk |= (cells[current + offset[lane]] != 0) << lane;
+
+	batch.validMask = 0;
+	for (int lane = 0;lane < 8;lane++) {
+		batch.index[lane] = current + offset[lane];
+		batch.g[lane] = g + (lane < 4 ? 1000 : 1414);
+		batch.f[lane] = batch.g[lane] + OctileDistance(x + offsetX[lane], y + offsetY[lane], goalX, goalY, 1000, 1414);
+
+		bool enterable = ((walk >> lane) & 1) || batch.index[lane] == goalIndex;
+		bool corners = lane < 4 || (((walk >> cornerA[lane]) & 1) && ((walk >> cornerB[lane]) & 1));
+		batch.validMask |= (enterable && corners) << lane;
+	}
+#endif
+}
+
+/*
+A* over a WalkableMask, 4-connected with unit costs, expanding each cell with ExpandNeighbors4.
+Same results and path shape as MapAStarSearch on the same map, in fewer instructions per expansion.
+*/
+std::vector<Cell> MaskAStarSearch(const WalkableMask &mask, int startX, int startY, int goalX, int goalY, SearchScratch &scratch);
+
+/*
+A* over a WalkableMask, 8-connected without corner cutting, expanding each cell with ExpandNeighbors8.
+Costs are in thousandths of a cell, so scratch.g of the goal is the path length times 1000.
+Returns every cell of the path after the start, or just the start if start and goal are the same cell.
+*/
+std::vector<Cell> MaskOctileAStarSearch(const WalkableMask &mask, int startX, int startY, int goalX, int goalY, SearchScratch &scratch);
+
+#endif
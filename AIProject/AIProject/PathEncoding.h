@@ -0,0 +1,88 @@
+#ifndef PATHENCODING_H
+#define PATHENCODING_H
+
+#include "Cell.h"
+
+#include <stddef.h>
+#include <vector>
+
+/*
+A path stored as its start cell and a bit stream of runs, each a direction code followed by how many steps it repeats.
+Directions take 2 bits (left, up, right, down), or 3 when the path has diagonal steps, and run lengths are Elias gamma coded,
+so a zigzag costs at most 3 bits a step and a straight corridor a few bits in total, against a whole Cell per step as a vector of Cell.
+Meant for paths kept around, like cached legs, and decoded when walked.
+*/
+class EncodedPath {
+public:
+	bool Encode(Cell start, const std::vector<Cell> &path); /* Encodes a path shaped like the searches return (cells after start, or just start). Returns false, leaving this empty, if two consecutive cells aren't neighbors */
+	bool EncodeIndices(int width, unsigned int start, const std::vector<unsigned int> &path); /* As above, for packed indices (x + y * width) */
+	void Clear(); /* Drops the path, freeing the bit stream */
+
+	bool IsEmpty() const; /* True when no path is held */
+	Cell GetStart() const;
+	int GetStepCount() const; /* Moves after the start, 0 for a start-is-goal path */
+	bool HasDiagonalSteps() const;
+	size_t GetByteCount() const; /* Size of the bit stream */
+
+	template <typename Visit>
+	void ForEachStep(Visit visit) const { /* Calls visit(x, y) for every cell after the start, in order */
+		static const int offsetX[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+		static const int offsetY[8] = { 0, -1, 0, 1, -1, -1, 1, 1 };
+
+		int x = startX;
+		int y = startY;
+		size_t position = 0;
+		for (int step = 0;step < stepCount;) {
+			int direction = (int)ReadBits(position, diagonal ? 3 : 2);
+			int run = (int)ReadRunLength(position);
+			for (int x2 = 0;x2 < run;x2++) {
+				x += offsetX[direction];
+				y += offsetY[direction];
+				visit(x, y);
+			}
+
+			step += run;
+		}
+	}
+
+	void Decode(std::vector<Cell> &path) const; /* Writes the path back in the searches' shape over path. Empty if IsEmpty */
+	void DecodeIndices(int width, std::vector<unsigned int> &path) const; /* As above, as packed indices */
+private:
+	template <typename Step>
+	bool EncodeSteps(int startX, int startY, int count, Step getStep); /* getStep(i, x, y) fills in the i-th cell after start */
+	void WriteBits(unsigned int value, int count); /* Appends count bits of value, lowest first */
+	void WriteRunLength(unsigned int run); /* Appends run (at least 1) Elias gamma coded */
+
+	unsigned int ReadBits(size_t &position, int count) const {
+		unsigned int value = 0;
+		for (int x = 0;x < count;x++, position++)
+			value |= ((bits[position >> 3] >> (position & 7)) & 1u) << x;
+
+		return value;
+	}
+
+	unsigned int ReadRunLength(size_t &position) const {
+		int zeros = 0;
+		while (((bits[position >> 3] >> (position & 7)) & 1u) == 0) {
+			zeros++;
+			position++;
+		}
+
+		//The leading 1 is the top bit, then the rest follow highest first
+		unsigned int run = 0;
+		for (int x = 0;x <= zeros;x++, position++)
+			run = (run << 1) | ((bits[position >> 3] >> (position & 7)) & 1u);
+
+		return run;
+	}
+
+	int startX = 0;
+	int startY = 0;
+	int stepCount = 0;
+	bool hasPath = false;
+	bool diagonal = false;
+	size_t bitCount = 0;
+	std::vector<unsigned char> bits;
+};
+
+#endif
@@ -0,0 +1,373 @@
+#ifndef PATHSERVER_CPP
+#define PATHSERVER_CPP
+#include "PathServer.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include <string.h>
+#include <iterator>
+
+/* Thin wrappers so the rest of the file doesn't care which C runtime it is on */
+static int ReadBytes(int fd, unsigned char *buffer, int size) {
+#ifdef _WIN32
+	return _read(fd, buffer, size);
+#else
+	return (int)read(fd, buffer, size);
+#endif
+}
+
+static int WriteBytes(int fd, const unsigned char *buffer, int size) {
+#ifdef _WIN32
+	return _write(fd, buffer, size);
+#else
+	return (int)write(fd, buffer, size);
+#endif
+}
+
+static void PutUint16(unsigned char *bytes, uint16_t value) {
+	bytes[0] = (unsigned char)(value & 0xFF);
+	bytes[1] = (unsigned char)(value >> 8);
+}
+
+static void PutUint32(unsigned char *bytes, uint32_t value) {
+	for (int x = 0;x < 4;x++)
+		bytes[x] = (unsigned char)((value >> (8 * x)) & 0xFF);
+}
+
+static uint16_t GetUint16(const unsigned char *bytes) {
+	return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+static uint32_t GetUint32(const unsigned char *bytes) {
+	return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+PathServer::Connection::Connection(int inputFd, int outputFd, bool ownsFds) {
+	this->inputFd = inputFd;
+	this->outputFd = outputFd;
+	this->ownsFds = ownsFds;
+}
+
+PathServer::Connection::~Connection() {
+#ifndef _WIN32
+	if (ownsFds) {
+		close(inputFd);
+		if (outputFd != inputFd)
+			close(outputFd);
+	}
+#endif
+}
+
+void PathServer::Connection::Write(const std::vector<unsigned char> &bytes) {
+	std::lock_guard<std::mutex> lock(writeMutex);
+	if (broken)
+		return;
+
+	//Writes may be partial on sockets and pipes, keep going until everything is out
+	int written = 0;
+	while (written < (int)bytes.size()) {
+		int result = WriteBytes(outputFd, bytes.data() + written, (int)bytes.size() - written);
+		if (result <= 0) {
+			broken = true;
+			return;
+		}
+		written += result;
+	}
+}
+
+void PathServer::Connection::Disconnect() {
+#ifndef _WIN32
+	if (ownsFds)
+		shutdown(inputFd, SHUT_RDWR);
+#endif
+}
+
+PathServer::PathServer(const Grid &grid) : scheduler(grid) {
+	dispatcher = std::thread(&PathServer::DispatchLoop, this);
+}
+
+PathServer::PathServer(const Grid &grid, int workerCount) : scheduler(grid, workerCount) {
+	dispatcher = std::thread(&PathServer::DispatchLoop, this);
+}
+
+PathServer::~PathServer() {
+	Stop();
+
+	//Socket readers hold a pointer to this server, wait for all of them to notice the disconnect
+	{
+		std::unique_lock<std::mutex> lock(readerMutex);
+		readerCondition.wait(lock, [this]() { return activeReaders == 0; });
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		stopping = true;
+	}
+	pendingCondition.notify_all();
+	if (dispatcher.joinable())
+		dispatcher.join();
+
+	scheduler.Shutdown();
+}
+
+void PathServer::SetMaxBatchSize(int size) {
+	maxBatchSize = (size < 1) ? 1 : size;
+}
+
+int PathServer::GetMaxBatchSize() {
+	return maxBatchSize;
+}
+
+void PathServer::SetBatchWindow(std::chrono::microseconds window) {
+	batchWindowMicroseconds = window.count();
+}
+
+std::chrono::microseconds PathServer::GetBatchWindow() {
+	return std::chrono::microseconds(batchWindowMicroseconds.load());
+}
+
+void PathServer::ServeStreams(int inputFd, int outputFd) {
+	ReadRequests(std::make_shared<Connection>(inputFd, outputFd, false));
+	Drain(); //Answer everything that was asked before returning
+}
+
+bool PathServer::ServeUnixSocket(const std::string &path) {
+#ifdef _WIN32
+	std::cerr << "Unix domain sockets are not supported on this platform, use the stdin/stdout mode instead." << std::endl;
+	return false;
+#else
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path))
+		return false;
+	strcpy(address.sun_path, path.c_str());
+
+	listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listenFd < 0)
+		return false;
+
+	unlink(path.c_str()); //Remove a stale socket left behind by a previous run
+	if (bind(listenFd, (sockaddr *)&address, sizeof(address)) < 0 || listen(listenFd, 64) < 0) {
+		close(listenFd);
+		listenFd = -1;
+		return false;
+	}
+
+	for (;;) {
+		int clientFd = accept(listenFd, nullptr, nullptr);
+		if (clientFd < 0)
+			break; //Stop shuts the listening socket down, which lands us here
+
+		std::shared_ptr<Connection> connection = std::make_shared<Connection>(clientFd, clientFd, true);
+		{
+			std::lock_guard<std::mutex> lock(pendingMutex);
+			if (stopping)
+				break;
+			connections.push_back(connection);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(readerMutex);
+			activeReaders++;
+		}
+
+		std::thread([this, connection]() {
+			ReadRequests(connection);
+
+			std::lock_guard<std::mutex> lock(readerMutex);
+			activeReaders--;
+			readerCondition.notify_all();
+		}).detach();
+	}
+
+	close(listenFd);
+	listenFd = -1;
+	unlink(path.c_str());
+	return true;
+#endif
+}
+
+void PathServer::Stop() {
+	std::vector<std::shared_ptr<Connection>> toDisconnect;
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		for (int x = 0;x < connections.size();x++) {
+			std::shared_ptr<Connection> connection = connections[x].lock();
+			if (connection != nullptr)
+				toDisconnect.push_back(connection);
+		}
+		connections.clear();
+	}
+
+#ifndef _WIN32
+	if (listenFd >= 0)
+		shutdown(listenFd, SHUT_RDWR);
+#endif
+
+	for (int x = 0;x < toDisconnect.size();x++)
+		toDisconnect[x]->Disconnect();
+}
+
+QueryScheduler &PathServer::GetScheduler() {
+	return scheduler;
+}
+
+int PathServer::GetBatchCount() {
+	return batchCount;
+}
+
+int PathServer::GetLargestBatch() {
+	return largestBatch;
+}
+
+bool PathServer::DecodeRequest(const unsigned char *bytes, uint32_t &requestId, PathQuery &query) {
+	requestId = GetUint32(bytes);
+
+	int algorithm = bytes[4];
+	int priority = bytes[5];
+	int timeoutMs = GetUint16(bytes + 6);
+
+	query.startX = GetUint16(bytes + 8);
+	query.startY = GetUint16(bytes + 10);
+	query.goalX = GetUint16(bytes + 12);
+	query.goalY = GetUint16(bytes + 14);
+
+	if (algorithm > (int)SearchAlgorithm::aStar || priority > (int)QueryPriority::player)
+		return false;
+
+	query.algorithm = (SearchAlgorithm)algorithm;
+	query.priority = (QueryPriority)priority;
+
+	//The timeout covers the whole query, queued time included
+	if (timeoutMs > 0) {
+		query.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+		query.cancellationToken = std::make_shared<CancellationToken>();
+		query.cancellationToken->SetDeadline(query.deadline);
+	}
+
+	return true;
+}
+
+void PathServer::EncodeRequest(uint32_t requestId, const PathQuery &query, int timeoutMs, unsigned char *bytes) {
+	PutUint32(bytes, requestId);
+	bytes[4] = (unsigned char)query.algorithm;
+	bytes[5] = (unsigned char)query.priority;
+	PutUint16(bytes + 6, (uint16_t)timeoutMs);
+	PutUint16(bytes + 8, (uint16_t)query.startX);
+	PutUint16(bytes + 10, (uint16_t)query.startY);
+	PutUint16(bytes + 12, (uint16_t)query.goalX);
+	PutUint16(bytes + 14, (uint16_t)query.goalY);
+}
+
+std::vector<unsigned char> PathServer::EncodeResponse(uint32_t requestId, const PathQueryResult &result) {
+	std::vector<unsigned char> bytes = std::vector<unsigned char>(responseHeaderSize + 4 * result.path.size());
+
+	PutUint32(bytes.data(), requestId);
+	bytes[4] = (unsigned char)result.status;
+	bytes[5] = (unsigned char)result.algorithmUsed;
+	PutUint16(bytes.data() + 6, 0);
+	PutUint32(bytes.data() + 8, (uint32_t)result.path.size());
+
+	for (int x = 0;x < result.path.size();x++) {
+		PutUint16(bytes.data() + responseHeaderSize + 4 * x, (uint16_t)result.path[x].x);
+		PutUint16(bytes.data() + responseHeaderSize + 4 * x + 2, (uint16_t)result.path[x].y);
+	}
+
+	return bytes;
+}
+
+void PathServer::ReadRequests(std::shared_ptr<Connection> connection) {
+	//Read in large chunks, every whole request in a chunk goes to the dispatcher under one lock
+	std::vector<unsigned char> buffer = std::vector<unsigned char>(requestSize * 256);
+	int buffered = 0;
+
+	for (;;) {
+		int result = ReadBytes(connection->inputFd, buffer.data() + buffered, (int)buffer.size() - buffered);
+		if (result <= 0)
+			break;
+		buffered += result;
+
+		int wholeRequests = buffered / requestSize;
+		if (wholeRequests == 0)
+			continue;
+
+		std::vector<PathQuery> decoded;
+		for (int x = 0;x < wholeRequests;x++) {
+			uint32_t requestId;
+			PathQuery query;
+
+			if (!DecodeRequest(buffer.data() + x * requestSize, requestId, query)) {
+				PathQueryResult rejectedResult;
+				rejectedResult.status = QueryStatus::rejected;
+				connection->Write(EncodeResponse(requestId, rejectedResult));
+				continue;
+			}
+
+			//Holding the connection keeps its descriptors open until this response is written
+			query.onComplete = [connection, requestId](const PathQueryResult &answer) {
+				connection->Write(EncodeResponse(requestId, answer));
+			};
+			decoded.push_back(std::move(query));
+		}
+
+		//Keep any partial request at the front of the buffer for the next read
+		memmove(buffer.data(), buffer.data() + wholeRequests * requestSize, buffered - wholeRequests * requestSize);
+		buffered -= wholeRequests * requestSize;
+
+		if (!decoded.empty()) {
+			{
+				std::lock_guard<std::mutex> lock(pendingMutex);
+				for (int x = 0;x < decoded.size();x++)
+					pending.push_back(std::move(decoded[x]));
+			}
+			pendingCondition.notify_all();
+		}
+	}
+}
+
+void PathServer::DispatchLoop() {
+	std::unique_lock<std::mutex> lock(pendingMutex);
+
+	for (;;) {
+		pendingCondition.wait(lock, [this]() { return stopping || !pending.empty(); });
+		if (stopping && pending.empty())
+			return;
+
+		//Give other clients a short window to join this batch, unless it is already full
+		pendingCondition.wait_for(lock, GetBatchWindow(), [this]() { return stopping || (int)pending.size() >= maxBatchSize; });
+
+		int size = ((int)pending.size() < maxBatchSize) ? (int)pending.size() : (int)maxBatchSize;
+		std::vector<PathQuery> batch = std::vector<PathQuery>(std::make_move_iterator(pending.begin()), std::make_move_iterator(pending.begin() + size));
+		pending.erase(pending.begin(), pending.begin() + size);
+
+		batchCount++;
+		if (size > largestBatch)
+			largestBatch = size;
+
+		//Submit without holding the lock so readers can keep queueing the next batch.
+		//The batch isn't visible to Drain until it is submitted, so hold off on notifying until then.
+		lock.unlock();
+		scheduler.SubmitBatch(std::move(batch));
+		lock.lock();
+
+		dispatchedBatches++;
+		pendingCondition.notify_all();
+	}
+}
+
+void PathServer::Drain() {
+	{
+		std::unique_lock<std::mutex> lock(pendingMutex);
+		pendingCondition.wait(lock, [this]() { return pending.empty() && dispatchedBatches == batchCount; });
+	}
+
+	scheduler.WaitUntilIdle();
+}
+#endif
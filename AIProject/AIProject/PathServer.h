@@ -0,0 +1,100 @@
+#ifndef PATHSERVER_H
+#define PATHSERVER_H
+
+#include "Grid.h"
+#include "PathQuery.h"
+#include "QueryScheduler.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+Answers path queries for one preloaded grid over a compact binary protocol, without the console UI.
+Requests from every connection are coalesced into batches and handed to a QueryScheduler.
+
+Wire format, all integers little-endian:
+	Request, 16 bytes:
+		uint32 requestId | uint8 algorithm | uint8 priority | uint16 timeoutMs (0 for none)
+		uint16 startX | uint16 startY | uint16 goalX | uint16 goalY
+	Response, 12 bytes + 4 bytes per path cell:
+		uint32 requestId | uint8 status | uint8 algorithmUsed | uint16 reserved (0) | uint32 pathLength
+		pathLength * (uint16 x | uint16 y)
+algorithm and status use the values of SearchAlgorithm and QueryStatus, priority the values of QueryPriority.
+Responses are written in completion order, not request order, so clients match them up by requestId.
+*/
+class PathServer {
+public:
+	static const int requestSize = 16; /* Size of a request on the wire */
+	static const int responseHeaderSize = 12; /* Size of a response before its path cells */
+
+	PathServer(const Grid &grid); /* Serves grid with one worker per hardware thread */
+	PathServer(const Grid &grid, int workerCount); /* Serves grid with workerCount workers */
+	~PathServer(); /* Stops the server and waits for the connection threads to finish */
+
+	void SetMaxBatchSize(int size); /* A batch is dispatched as soon as it holds this many queries */
+	int GetMaxBatchSize(); /* Returns the maximum batch size */
+	void SetBatchWindow(std::chrono::microseconds window); /* How long the first query of a batch waits for others to join it */
+	std::chrono::microseconds GetBatchWindow(); /* Returns the batch window */
+
+	void ServeStreams(int inputFd, int outputFd); /* Serves a single client over two file descriptors, e.g. stdin and stdout, until the input closes */
+	bool ServeUnixSocket(const std::string &path); /* Accepts clients on a Unix domain socket until Stop. Returns false if the socket couldn't be opened or on Windows */
+	void Stop(); /* Stops accepting clients and disconnects the connected ones */
+
+	QueryScheduler &GetScheduler(); /* Returns the scheduler, e.g. for its stats or to replace the grid */
+	int GetBatchCount(); /* Returns how many batches have been dispatched */
+	int GetLargestBatch(); /* Returns the size of the largest batch dispatched */
+
+	static bool DecodeRequest(const unsigned char *bytes, uint32_t &requestId, PathQuery &query); /* Decodes one request. Returns false if the algorithm or priority is unknown */
+	static void EncodeRequest(uint32_t requestId, const PathQuery &query, int timeoutMs, unsigned char *bytes); /* Encodes one request into requestSize bytes */
+	static std::vector<unsigned char> EncodeResponse(uint32_t requestId, const PathQueryResult &result); /* Encodes one response */
+private:
+	/* One client. The descriptors are closed once the last pending response holding it is written */
+	class Connection {
+	public:
+		Connection(int inputFd, int outputFd, bool ownsFds);
+		~Connection();
+
+		void Write(const std::vector<unsigned char> &bytes); /* Writes a whole response, serialized with other workers */
+		void Disconnect(); /* Wakes up a reader blocked on this connection */
+
+		int inputFd;
+		int outputFd;
+		bool ownsFds; /* Sockets are closed by the connection, stdin and stdout are not */
+		std::mutex writeMutex;
+		std::atomic<bool> broken{ false }; /* Set once a write fails, later responses are discarded */
+	};
+
+	void ReadRequests(std::shared_ptr<Connection> connection); /* Reads requests until the input closes, queueing them for the dispatcher */
+	void DispatchLoop(); /* Coalesces pending queries into batches for the scheduler */
+	void Drain(); /* Waits until every request read so far has been answered */
+
+	QueryScheduler scheduler;
+
+	std::mutex pendingMutex; /* Guards pending, stopping and connections */
+	std::condition_variable pendingCondition; /* Signalled when queries are added or taken */
+	std::vector<PathQuery> pending; /* Queries waiting to join a batch */
+	std::vector<std::weak_ptr<Connection>> connections; /* Socket clients, disconnected on Stop */
+	bool stopping = false;
+	int dispatchedBatches = 0; /* Batches handed to the scheduler, Drain waits for this to catch up with batchCount */
+
+	std::mutex readerMutex; /* Paired with readerCondition */
+	std::condition_variable readerCondition; /* Signalled when a socket client's reader finishes */
+	int activeReaders = 0; /* Socket clients still being read from */
+
+	int listenFd = -1;
+	std::thread dispatcher;
+
+	std::atomic<int> maxBatchSize{ 64 };
+	std::atomic<long long> batchWindowMicroseconds{ 500 };
+	std::atomic<int> batchCount{ 0 };
+	std::atomic<int> largestBatch{ 0 };
+};
+
+#endif
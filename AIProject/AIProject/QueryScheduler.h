@@ -0,0 +1,120 @@
+#ifndef QUERYSCHEDULER_H
+#define QUERYSCHEDULER_H
+
+#include "Grid.h"
+#include "PathQuery.h"
+#include "SearchArena.h"
+#include "SearchFuture.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* A snapshot of the scheduler's counters */
+class SchedulerStats {
+public:
+	int queueDepth = 0; /* Queries currently waiting for a worker */
+	int peakQueueDepth = 0; /* Largest queueDepth seen so far */
+	int submitted = 0; /* Queries handed to Submit */
+	int completed = 0; /* Queries answered with their requested algorithm */
+	int degraded = 0; /* Queries answered with GreedySearch instead */
+	int dropped = 0; /* Queries whose deadline passed before a worker reached them */
+	int rejected = 0; /* Queries refused by admission control */
+	int cancelled = 0; /* Queries stopped by their cancellation token, before or during the search, or still queued at Shutdown */
+	int deadlineMisses = 0; /* Dropped queries plus answers delivered after their deadline */
+	long long searchHeapAllocations = 0; /* Blocks the workers' search arenas took from the global heap. Flat once every worker has warmed up */
+	long long searchArenaBytes = 0; /* Memory held by the workers' search arenas */
+};
+
+/*
+Schedules path queries onto a pool of worker threads, each owning a private copy of the grid.
+Every worker has its own priority queue ordered by priority, then deadline, then submission order.
+Idle workers steal the most urgent query from the other workers' queues.
+*/
+class QueryScheduler {
+public:
+	QueryScheduler(const Grid &grid); /* Starts one worker per hardware thread, searching copies of grid */
+	QueryScheduler(const Grid &grid, int workerCount); /* Starts workerCount workers, searching copies of grid */
+	~QueryScheduler(); /* Stops the workers. Queries still queued are completed as cancelled */
+
+	bool Submit(PathQuery query); /* Queues a query. Returns false if it was rejected, after calling its onComplete */
+	int SubmitBatch(std::vector<PathQuery> queries); /* Queues several queries, taking each worker's queue lock once. Returns how many were accepted */
+	SearchFuture SubmitAsync(PathQuery query); /* Queues a query and returns a future for its result. Creates a cancellation token if the query has none */
+
+	void SetGrid(const Grid &grid); /* Replaces the grid. Each worker picks up the new copy before its next query */
+
+	void SetMaxQueueDepth(int depth); /* Past this depth only player queries are admitted. 0 means unlimited */
+	int GetMaxQueueDepth(); /* Returns the admission control depth */
+	void SetDegradeQueueDepth(int depth); /* Past this depth degradable queries are answered with GreedySearch. 0 means never */
+	int GetDegradeQueueDepth(); /* Returns the degrade depth */
+
+	int GetWorkerCount(); /* Returns the number of worker threads */
+	SchedulerStats GetStats(); /* Returns a snapshot of the queue depth and outcome counters */
+
+	void WaitUntilIdle(); /* Blocks until every queued query has been answered */
+	void Shutdown(); /* Stops and joins the workers, then completes every query still queued as cancelled. Called by the destructor */
+private:
+	/* A queued query plus the order it was submitted in, used to break ties */
+	class QueuedQuery {
+	public:
+		PathQuery query;
+		unsigned long long sequence = 0;
+	};
+
+	/* One worker's queue and grid. The mutex only guards the queue */
+	class Worker {
+	public:
+		std::mutex queueMutex;
+		std::vector<QueuedQuery> queue; /* Binary heap, most urgent query on top */
+		Grid grid; /* This worker's private copy of the grid */
+		int gridVersion = 0; /* The version of sharedGrid this worker's copy was made from */
+		std::thread thread;
+		std::atomic<long long> arenaHeapAllocations{ 0 }; /* Copied from the thread's SearchArena after each search, for GetStats */
+		std::atomic<long long> arenaBytes{ 0 };
+	};
+
+	void StartWorkers(const Grid &grid, int workerCount);
+	bool Admit(PathQuery &query); /* Bounds and admission control checks. Calls onComplete and returns false if rejected */
+	QueuedQuery Enqueue(PathQuery &query); /* Moves an admitted query into a QueuedQuery and counts it as queued */
+	void WorkerLoop(int index);
+	bool PopQuery(int index, QueuedQuery &out); /* Pops from the worker's own queue, or steals from another */
+	void RunQuery(Worker &worker, QueuedQuery &queued);
+	void Abandon(QueuedQuery &queued); /* Completes an enqueued query that will never be searched as cancelled, and uncounts it */
+	void Finish(PathQuery &query, PathQueryResult &result);
+
+	static bool IsLessUrgent(const QueuedQuery &a, const QueuedQuery &b); /* Heap ordering, true if a should run after b */
+
+	std::vector<std::unique_ptr<Worker>> workers;
+
+	std::mutex gridMutex; /* Guards sharedGrid and gridVersion */
+	Grid sharedGrid; /* The most recent grid handed to SetGrid */
+	int gridVersion = 0;
+
+	std::mutex wakeMutex; /* Paired with wakeCondition and idleCondition */
+	std::condition_variable wakeCondition; /* Signalled when a query is queued or the scheduler stops */
+	std::condition_variable idleCondition; /* Signalled when the last outstanding query is answered */
+	std::atomic<bool> stopping{ false };
+
+	std::atomic<unsigned long long> nextSequence{ 0 }; /* Submission counter used to keep equal queries in FIFO order */
+	std::atomic<unsigned int> nextWorker{ 0 }; /* Round-robin cursor used to spread submissions across worker queues */
+	std::atomic<int> queueDepth{ 0 }; /* Queries waiting in any worker queue */
+	std::atomic<int> outstanding{ 0 }; /* Queries queued or currently being searched */
+
+	std::atomic<int> maxQueueDepth{ 0 };
+	std::atomic<int> degradeQueueDepth{ 0 };
+
+	std::atomic<int> peakQueueDepth{ 0 };
+	std::atomic<int> submitted{ 0 };
+	std::atomic<int> completed{ 0 };
+	std::atomic<int> degraded{ 0 };
+	std::atomic<int> dropped{ 0 };
+	std::atomic<int> rejected{ 0 };
+	std::atomic<int> cancelled{ 0 };
+	std::atomic<int> deadlineMisses{ 0 };
+};
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef REALTIMESEARCH_CPP
+#define REALTIMESEARCH_CPP
+#include "RealTimeSearch.h"
+
+#include <algorithm>
+
+LearnedHeuristic::LearnedHeuristic(Grid &grid, int goalX, int goalY) : grid(grid) {
+	this->goalX = goalX;
+	this->goalY = goalY;
+	Resize();
+	forgetCount = 0;
+	listenerId = grid.AddChangeListener([this](const GridChange &change) { OnGridChanged(change); });
+}
+
+LearnedHeuristic::~LearnedHeuristic() {
+	grid.RemoveChangeListener(listenerId);
+}
+
+void LearnedHeuristic::Raise(int index, int value) {
+	if (learnedStamp[index] != generation) {
+		if (value <= GetIndex(index))
+			return;
+
+		learnedStamp[index] = generation;
+		learnedCount++;
+	}
+	else if (value <= learned[index]) {
+		return;
+	}
+
+	learned[index] = value;
+}
+
+void LearnedHeuristic::SetGoal(int goalX, int goalY) {
+	this->goalX = goalX;
+	this->goalY = goalY;
+	Forget();
+}
+
+void LearnedHeuristic::Forget() {
+	generation++;
+	if (generation == 0) {
+		//Stamps only need clearing once every 4 billion forgets
+		learnedStamp.assign(learnedStamp.size(), 0);
+		generation = 1;
+	}
+
+	learnedCount = 0;
+	forgetCount++;
+}
+
+int LearnedHeuristic::GetGoalX() const {
+	return goalX;
+}
+
+int LearnedHeuristic::GetGoalY() const {
+	return goalY;
+}
+
+int LearnedHeuristic::GetGridX() const {
+	return width;
+}
+
+int LearnedHeuristic::GetGridY() const {
+	return height;
+}
+
+int LearnedHeuristic::GetLearnedCount() const {
+	return learnedCount;
+}
+
+int LearnedHeuristic::GetForgetCount() const {
+	return forgetCount;
+}
+
+void LearnedHeuristic::OnGridChanged(const GridChange &change) {
+	if (change.type == GridChangeType::resized || grid.GetGridX() != width || grid.GetGridY() != height) {
+		Resize();
+		return;
+	}
+
+	if (change.type != GridChangeType::tiles)
+		return; //Start and goal markers don't block anything
+
+	int x1 = std::max(change.x1, 0);
+	int y1 = std::max(change.y1, 0);
+	int x2 = std::min(change.x2, width - 1);
+	int y2 = std::min(change.y2, height - 1);
+
+	bool wallRemoved = false;
+	for (int y = y1;y <= y2;y++) {
+		for (int x = x1;x <= x2;x++) {
+			unsigned char open = grid.IsWalkable(x, y) ? 1 : 0;
+			if (open && !walkable[x + y * width])
+				wallRemoved = true;
+
+			walkable[x + y * width] = open;
+		}
+	}
+
+	//New walls only lengthen paths, so the learned values are still lower bounds
+	if (wallRemoved)
+		Forget();
+}
+
+void LearnedHeuristic::Resize() {
+	width = grid.GetGridX();
+	height = grid.GetGridY();
+	learned.assign(width * height, 0);
+	learnedStamp.assign(width * height, 0);
+	walkable.assign(width * height, 0);
+	for (int y = 0;y < height;y++) {
+		for (int x = 0;x < width;x++)
+			walkable[x + y * width] = grid.IsWalkable(x, y) ? 1 : 0;
+	}
+
+	Forget();
+}
+
+RealTimeAgent::RealTimeAgent(Grid &grid, LearnedHeuristic &heuristic, int lookahead) : grid(grid), heuristic(heuristic) {
+	this->lookahead = std::max(lookahead, 1);
+
+	//Each expansion pushes at most 4 open entries, so nothing a step does can outgrow these
+	scratch.Begin(grid.GetGridX() * grid.GetGridY());
+	scratch.open.reserve(this->lookahead * 4 + 1);
+	closedCells.reserve(this->lookahead);
+}
+
+void RealTimeAgent::SetPosition(int x, int y) {
+	this->x = x;
+	this->y = y;
+}
+
+Cell RealTimeAgent::GetPosition() const {
+	return Cell(x, y);
+}
+
+bool RealTimeAgent::IsAtGoal() const {
+	return x == heuristic.GetGoalX() && y == heuristic.GetGoalY();
+}
+
+bool RealTimeAgent::Step() {
+	int width = grid.GetGridX();
+	int height = grid.GetGridY();
+	int goalX = heuristic.GetGoalX();
+	int goalY = heuristic.GetGoalY();
+
+	closedCells.clear();
+	if (IsAtGoal() || x < 0 || x >= width || y < 0 || y >= height || goalX < 0 || goalX >= width || goalY < 0 || goalY >= height)
+		return false;
+
+	int startIndex = x + y * width;
+	int goalIndex = goalX + goalY * width;
+
+	scratch.Begin(width * height);
+	scratch.See(startIndex, 0, -1);
+	scratch.open.push_back(((long long)heuristic.GetIndex(startIndex) << 32) | startIndex);
+
+	const int offsetX[4] = { -1, 0, 1, 0 };
+	const int offsetY[4] = { 0, -1, 0, 1 };
+
+	int target = -1;
+	while (!scratch.open.empty()) {
+		std::pop_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		int current = (int)(scratch.open.back() & 0xFFFFFFFF);
+		scratch.open.pop_back();
+
+		if (scratch.IsClosed(current))
+			continue;
+
+		//Stop at the goal or once the budget is spent, the cell on top of the open list is the best one on the frontier
+		if (current == goalIndex || (int)closedCells.size() == lookahead) {
+			target = current;
+			break;
+		}
+
+		scratch.Close(current);
+		closedCells.push_back(current);
+
+		int currentX = current % width;
+		int currentY = current / width;
+		for (int direction = 0;direction < 4;direction++) {
+			int neighborX = currentX + offsetX[direction];
+			int neighborY = currentY + offsetY[direction];
+			int neighbor = neighborX + neighborY * width;
+			if (neighborX < 0 || neighborX >= width || neighborY < 0 || neighborY >= height)
+				continue;
+			if (neighbor != goalIndex && !grid.IsWalkable(neighborX, neighborY))
+				continue;
+
+			int cost = scratch.g[current] + 1;
+			if (scratch.IsClosed(neighbor) || (scratch.IsSeen(neighbor) && scratch.g[neighbor] <= cost))
+				continue;
+
+			scratch.See(neighbor, cost, current);
+			scratch.open.push_back(((long long)(cost + heuristic.GetIndex(neighbor)) << 32) | neighbor);
+			std::push_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		}
+	}
+
+	scratch.expandedCells = (int)closedCells.size();
+	if (target == -1)
+		return false; //Everything reachable was expanded without meeting the goal
+
+	//RTAA* update: every expanded cell is at least (best frontier f - its g) away from the goal
+	int bestF = scratch.g[target] + heuristic.GetIndex(target);
+	for (int cell = 0;cell < closedCells.size();cell++)
+		heuristic.Raise(closedCells[cell], bestF - scratch.g[closedCells[cell]]);
+
+	int next = target;
+	while (scratch.parent[next] != startIndex)
+		next = scratch.parent[next];
+
+	x = next % width;
+	y = next / width;
+	return true;
+}
+
+int RealTimeAgent::GetLookahead() const {
+	return lookahead;
+}
+
+int RealTimeAgent::GetLastExpandedCells() const {
+	return scratch.expandedCells;
+}
+#endif
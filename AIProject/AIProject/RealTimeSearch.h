@@ -0,0 +1,92 @@
+#ifndef REALTIMESEARCH_H
+#define REALTIMESEARCH_H
+
+#include "Grid.h"
+#include "GridChange.h"
+#include "Heuristics.h"
+#include "MapSearch.h"
+
+#include <vector>
+
+/*
+Learned cost-to-goal estimates for one goal on one Grid, kept between trips.
+Every cell starts at its Manhattan distance to the goal and real-time agents only ever raise it,
+so repeated trips keep refining the same table towards the true distances.
+
+Adding walls can only make true distances longer, so learned values stay admissible and are kept.
+Removing a wall can make them too high, so the table listens to the grid and forgets everything it learned when that happens.
+Forgetting is O(1), values are stamped with a generation instead of being cleared.
+Like Grid it is single-threaded, don't attach one to a grid edited through a RegionLockedGrid.
+*/
+class LearnedHeuristic {
+public:
+	LearnedHeuristic(Grid &grid, int goalX, int goalY); /* Starts an empty table and subscribes to grid's changes. The grid must outlive this object */
+	~LearnedHeuristic(); /* Unsubscribes from the grid */
+
+	int Get(int x, int y) const { return GetIndex(x + y * width); } /* Returns the estimate at an in-bounds cell */
+	int GetIndex(int index) const { return learnedStamp[index] == generation ? learned[index] : ManhattanDistance(index % width, index / width, goalX, goalY); }
+	void Raise(int index, int value); /* Raises the estimate at index to value, if that is higher */
+
+	void SetGoal(int goalX, int goalY); /* Points the table at a new goal, forgetting what was learned */
+	void Forget(); /* Drops every learned value back to Manhattan distance */
+
+	int GetGoalX() const;
+	int GetGoalY() const;
+	int GetGridX() const;
+	int GetGridY() const;
+	int GetLearnedCount() const; /* Returns how many cells hold a learned value */
+	int GetForgetCount() const; /* Returns how many times the table has been forgotten since it was made */
+private:
+	LearnedHeuristic(const LearnedHeuristic &) = delete;
+	LearnedHeuristic &operator=(const LearnedHeuristic &) = delete;
+
+	void OnGridChanged(const GridChange &change);
+	void Resize(); /* Matches the table and wall snapshot to the grid, forgetting everything */
+
+	Grid &grid;
+	int goalX;
+	int goalY;
+	int width = 0;
+	int height = 0;
+	int listenerId = 0;
+	int learnedCount = 0;
+	int forgetCount = 0;
+	std::vector<int> learned; /* Row-major, valid where learnedStamp matches generation */
+	std::vector<unsigned int> learnedStamp;
+	unsigned int generation = 1;
+	std::vector<unsigned char> walkable; /* What the grid looked like when values were learned, to spot removed walls */
+};
+
+/*
+An agent walking to its heuristic's goal with Real-Time Adaptive A* (RTAA*), one cell per Step.
+Each step runs an A* from the agent's cell that stops after lookahead expansions, raises the learned estimate of
+every expanded cell to (best f on the frontier - its g), and moves one cell towards the best frontier cell.
+With a lookahead of 1 this is LRTA*. The agent always reaches a reachable goal, and trips after the first get shorter
+as the table learns, ending on shortest paths.
+
+All memory is reserved up front, so a step does O(lookahead) work and never allocates unless the grid has grown.
+Like Grid's searches, the goal may always be entered.
+*/
+class RealTimeAgent {
+public:
+	RealTimeAgent(Grid &grid, LearnedHeuristic &heuristic, int lookahead); /* Both must outlive this object */
+
+	void SetPosition(int x, int y); /* Teleports the agent, e.g. back to the start for another trip */
+	Cell GetPosition() const;
+	bool IsAtGoal() const;
+
+	bool Step(); /* Moves the agent one cell. Returns false without moving if it's at the goal or the goal can't be reached */
+
+	int GetLookahead() const;
+	int GetLastExpandedCells() const; /* Returns how many cells the last step expanded */
+private:
+	Grid &grid;
+	LearnedHeuristic &heuristic;
+	int lookahead;
+	int x = 0;
+	int y = 0;
+	SearchScratch scratch;
+	std::vector<int> closedCells; /* Cells expanded by the current step, whose estimates get raised */
+};
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef REGIONLOCKEDGRID_CPP
+#define REGIONLOCKEDGRID_CPP
+#include "RegionLockedGrid.h"
+
+#include <algorithm>
+
+RegionLockGuard::RegionLockGuard() {
+}
+
+RegionLockGuard::RegionLockGuard(RegionLockGuard &&other) {
+	owner = other.owner;
+	regions = std::move(other.regions);
+	exclusive = other.exclusive;
+	other.owner = nullptr;
+	other.regions.clear();
+}
+
+RegionLockGuard &RegionLockGuard::operator=(RegionLockGuard &&other) {
+	if (this != &other) {
+		Release();
+		owner = other.owner;
+		regions = std::move(other.regions);
+		exclusive = other.exclusive;
+		other.owner = nullptr;
+		other.regions.clear();
+	}
+	return *this;
+}
+
+RegionLockGuard::~RegionLockGuard() {
+	Release();
+}
+
+void RegionLockGuard::Release() {
+	if (owner != nullptr)
+		owner->UnlockRegions(regions, exclusive);
+
+	owner = nullptr;
+	regions.clear();
+}
+
+int RegionLockGuard::GetLockedRegionCount() {
+	return (int)regions.size();
+}
+
+RegionLockedGrid::RegionLockedGrid(Grid &grid) : RegionLockedGrid(grid, 32) {
+}
+
+RegionLockedGrid::RegionLockedGrid(Grid &grid, int regionSize) : grid(grid) {
+	this->regionSize = (regionSize < 1) ? 1 : regionSize;
+	regionsX = (grid.GetGridX() + this->regionSize - 1) / this->regionSize;
+	regionsY = (grid.GetGridY() + this->regionSize - 1) / this->regionSize;
+	regionLocks = std::unique_ptr<std::shared_timed_mutex[]>(new std::shared_timed_mutex[regionsX * regionsY]);
+}
+
+bool RegionLockedGrid::SetCell(int x, int y, Tile tile) {
+	if (x < 0 || x >= grid.GetGridX() || y < 0 || y >= grid.GetGridY())
+		return false;
+
+	RegionLockGuard guard = LockRegions(std::vector<int>(1, GetRegionIndex(x, y)), true);
+	grid.SetCell(x, y, tile);
+	return true;
+}
+
+int RegionLockedGrid::ApplyEdits(const std::vector<CellEdit> &edits) {
+	std::vector<int> regions;
+	for (int x = 0;x < edits.size();x++) {
+		if (edits[x].x >= 0 && edits[x].x < grid.GetGridX() && edits[x].y >= 0 && edits[x].y < grid.GetGridY())
+			regions.push_back(GetRegionIndex(edits[x].x, edits[x].y));
+	}
+
+	//Take every lock up front, in order, so the whole batch lands at once and can't deadlock with another batch
+	RegionLockGuard guard = LockRegions(regions, true);
+	return grid.ApplyEdits(edits);
+}
+
+int RegionLockedGrid::FillRect(int x1, int y1, int x2, int y2, Tile tile) {
+	RegionLockGuard guard = LockForWrite(x1, y1, x2, y2);
+	return grid.FillRect(x1, y1, x2, y2, tile);
+}
+
+Tile RegionLockedGrid::GetTile(int x, int y) {
+	if (x < 0 || x >= grid.GetGridX() || y < 0 || y >= grid.GetGridY()) //Outside of the grid is treated like the outer walls
+		return Tile::wall;
+
+	RegionLockGuard guard = LockRegions(std::vector<int>(1, GetRegionIndex(x, y)), false);
+	return grid.GetCell(x, y).tileType;
+}
+
+RegionLockGuard RegionLockedGrid::LockForRead(int x1, int y1, int x2, int y2) {
+	return LockRegions(GetRegionsInRect(x1, y1, x2, y2), false);
+}
+
+RegionLockGuard RegionLockedGrid::LockForWrite(int x1, int y1, int x2, int y2) {
+	return LockRegions(GetRegionsInRect(x1, y1, x2, y2), true);
+}
+
+std::vector<Cell> RegionLockedGrid::AStarSearch(int startX, int startY, int goalX, int goalY, SearchScratch &scratch) {
+	//A path can wander anywhere, so hold every region. Other searches share the locks, writers wait until we're done.
+	RegionLockGuard guard = LockForRead(0, 0, grid.GetGridX() - 1, grid.GetGridY() - 1);
+	return MapAStarSearch(grid, startX, startY, goalX, goalY, scratch);
+}
+
+Grid &RegionLockedGrid::GetGrid() {
+	return grid;
+}
+
+int RegionLockedGrid::GetRegionSize() {
+	return regionSize;
+}
+
+int RegionLockedGrid::GetRegionCount() {
+	return regionsX * regionsY;
+}
+
+int RegionLockedGrid::GetRegionIndex(int x, int y) {
+	return x / regionSize + (y / regionSize) * regionsX;
+}
+
+long long RegionLockedGrid::GetContendedLockCount() {
+	return contendedLocks;
+}
+
+RegionLockGuard RegionLockedGrid::LockRegions(std::vector<int> regions, bool exclusive) {
+	//Ascending order is the one global lock order every caller follows
+	std::sort(regions.begin(), regions.end());
+	regions.erase(std::unique(regions.begin(), regions.end()), regions.end());
+
+	for (int x = 0;x < regions.size();x++) {
+		std::shared_timed_mutex &lock = regionLocks[regions[x]];
+
+		//Try first so contention shows up in the stats, then block
+		if (exclusive) {
+			if (!lock.try_lock()) {
+				contendedLocks++;
+				lock.lock();
+			}
+		} else {
+			if (!lock.try_lock_shared()) {
+				contendedLocks++;
+				lock.lock_shared();
+			}
+		}
+	}
+
+	RegionLockGuard guard;
+	guard.owner = this;
+	guard.regions = std::move(regions);
+	guard.exclusive = exclusive;
+	return guard;
+}
+
+void RegionLockedGrid::UnlockRegions(const std::vector<int> &regions, bool exclusive) {
+	for (int x = (int)regions.size() - 1;x >= 0;x--) {
+		if (exclusive)
+			regionLocks[regions[x]].unlock();
+		else
+			regionLocks[regions[x]].unlock_shared();
+	}
+}
+
+std::vector<int> RegionLockedGrid::GetRegionsInRect(int x1, int y1, int x2, int y2) {
+	//Clamp the rectangle to the grid, then list the regions it covers row by row, which is already ascending
+	x1 = std::max(0, std::min(x1, grid.GetGridX() - 1));
+	x2 = std::max(0, std::min(x2, grid.GetGridX() - 1));
+	y1 = std::max(0, std::min(y1, grid.GetGridY() - 1));
+	y2 = std::max(0, std::min(y2, grid.GetGridY() - 1));
+
+	std::vector<int> regions;
+	for (int ry = std::min(y1, y2) / regionSize;ry <= std::max(y1, y2) / regionSize;ry++) {
+		for (int rx = std::min(x1, x2) / regionSize;rx <= std::max(x1, x2) / regionSize;rx++)
+			regions.push_back(rx + ry * regionsX);
+	}
+
+	return regions;
+}
+#endif
@@ -0,0 +1,80 @@
+#ifndef REGIONLOCKEDGRID_H
+#define REGIONLOCKEDGRID_H
+
+#include "Cell.h"
+#include "Grid.h"
+#include "MapSearch.h"
+
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+class RegionLockedGrid;
+
+/* Holds a set of region locks until it is destroyed or released. Movable, not copyable */
+class RegionLockGuard {
+public:
+	RegionLockGuard(); /* A guard holding nothing */
+	RegionLockGuard(RegionLockGuard &&other);
+	RegionLockGuard &operator=(RegionLockGuard &&other);
+	~RegionLockGuard(); /* Releases every held lock */
+
+	void Release(); /* Releases every held lock early */
+	int GetLockedRegionCount(); /* Returns how many regions this guard holds */
+private:
+	friend class RegionLockedGrid;
+	RegionLockGuard(const RegionLockGuard &) = delete;
+	RegionLockGuard &operator=(const RegionLockGuard &) = delete;
+
+	RegionLockedGrid *owner = nullptr;
+	std::vector<int> regions; /* Locked regions, in ascending order */
+	bool exclusive = false;
+};
+
+/*
+Lets several threads edit and search one Grid at once.
+The grid is split into square regions, each with its own reader/writer lock:
+	- SetCell locks only the region holding the cell, so writers in different regions never wait on each other.
+	  Subscribing a change listener, or opening an edit batch, costs that: each edit then also takes the grid's change feed lock
+	  briefly, and listeners run on the writing thread while it still holds its region locks
+	- Multi-region operations always lock regions in ascending index order, so they can't deadlock
+	- Searches hold shared locks on every region they may read, so they see a consistent grid while writers elsewhere queue up
+ResizeGrid, SetStartPos and SetGoalPos on the underlying grid are not covered, call them while nothing else uses it.
+*/
+class RegionLockedGrid {
+public:
+	RegionLockedGrid(Grid &grid); /* Wraps grid with 32x32 regions. The grid must outlive this object */
+	RegionLockedGrid(Grid &grid, int regionSize); /* Wraps grid with regionSize x regionSize regions */
+
+	bool SetCell(int x, int y, Tile tile); /* Sets one tile under its region's exclusive lock. Returns false if out of bounds */
+	int ApplyEdits(const std::vector<CellEdit> &edits); /* Applies every in-bounds edit under one set of exclusive locks. Returns how many were applied */
+	int FillRect(int x1, int y1, int x2, int y2, Tile tile); /* Fills the inclusive rectangle under exclusive locks on the regions it covers. Returns how many cells were in bounds */
+	Tile GetTile(int x, int y); /* Reads one tile under its region's shared lock. Out of bounds reads as a wall */
+
+	RegionLockGuard LockForRead(int x1, int y1, int x2, int y2); /* Shared locks on every region overlapping the inclusive rectangle */
+	RegionLockGuard LockForWrite(int x1, int y1, int x2, int y2); /* Exclusive locks on every region overlapping the inclusive rectangle */
+
+	std::vector<Cell> AStarSearch(int startX, int startY, int goalX, int goalY, SearchScratch &scratch); /* MapAStarSearch under shared locks on the whole grid */
+
+	Grid &GetGrid(); /* Returns the wrapped grid. Only touch it while holding the matching locks */
+	int GetRegionSize(); /* Returns the width and height of a region in tiles */
+	int GetRegionCount(); /* Returns the number of regions */
+	int GetRegionIndex(int x, int y); /* Returns the region holding (x, y) */
+	long long GetContendedLockCount(); /* Returns how many lock acquisitions had to wait for another thread */
+private:
+	friend class RegionLockGuard;
+
+	RegionLockGuard LockRegions(std::vector<int> regions, bool exclusive); /* Sorts, deduplicates and locks regions in ascending order */
+	void UnlockRegions(const std::vector<int> &regions, bool exclusive);
+	std::vector<int> GetRegionsInRect(int x1, int y1, int x2, int y2);
+
+	Grid &grid;
+	int regionSize;
+	int regionsX; /* Regions per row */
+	int regionsY; /* Regions per column */
+	std::unique_ptr<std::shared_timed_mutex[]> regionLocks; /* Row-major, region (rx, ry) at rx + ry * regionsX */
+	std::atomic<long long> contendedLocks{ 0 };
+};
+
+#endif
@@ -0,0 +1,240 @@
+#ifndef ROUTEPLANNER_CPP
+#define ROUTEPLANNER_CPP
+#include "RoutePlanner.h"
+
+#include <algorithm>
+
+RoutePlanner::RoutePlanner(Grid &grid) : grid(grid) {
+}
+
+Route RoutePlanner::PlanRoute(Cell start, const std::vector<Cell> &waypoints, bool returnToStart) {
+	Route route;
+
+	//Any edit to the grid can change any leg
+	if (grid.GetVersion() != cachedVersion || grid.GetGridX() != cachedWidth || grid.GetGridY() != cachedHeight) {
+		ClearCache();
+		cachedVersion = grid.GetVersion();
+		cachedWidth = grid.GetGridX();
+		cachedHeight = grid.GetGridY();
+	}
+
+	std::vector<Cell> points;
+	points.push_back(Cell(start.x, start.y));
+	for (int x = 0;x < waypoints.size();x++)
+		points.push_back(Cell(waypoints[x].x, waypoints[x].y));
+
+	CacheDistances(points);
+
+	//Point 0 is the start. Waypoints it can't reach are reported and left out of the tour
+	std::vector<int> stops;
+	for (int x = 1;x < points.size();x++) {
+		if (legs[GetLegKey(points[0], points[x])].cost < 0)
+			route.unreachable.push_back(points[x]);
+		else
+			stops.push_back(x);
+	}
+
+	//Nearest neighbour: keep walking to the closest stop not visited yet
+	std::vector<int> tour;
+	tour.push_back(0);
+	while (!stops.empty()) {
+		int best = 0;
+		for (int x = 1;x < stops.size();x++) {
+			if (GetDistance(points, tour.back(), stops[x]) < GetDistance(points, tour.back(), stops[best]))
+				best = x;
+		}
+
+		tour.push_back(stops[best]);
+		stops.erase(stops.begin() + best);
+	}
+
+	//Alternate the two local searches until neither finds anything. Each applied move strictly lowers the cost, so this ends
+	while (ImproveTwoOpt(points, tour, returnToStart) || ImproveOrOpt(points, tour, returnToStart)) {
+	}
+
+	if (returnToStart && tour.size() > 1)
+		tour.push_back(0);
+
+	for (int x = 1;x < tour.size();x++) {
+		if (tour[x] != 0)
+			route.order.push_back(points[tour[x]]);
+
+		Cell from = points[tour[x - 1]];
+		Cell to = points[tour[x]];
+		if (from.x == to.x && from.y == to.y)
+			continue; //Standing still, nothing to add
+
+		const EncodedPath &leg = GetLegPath(from, to);
+		route.path.reserve(route.path.size() + leg.GetStepCount());
+		leg.ForEachStep([&](int x, int y) { route.path.push_back(Cell(x, y)); });
+		route.cost += leg.GetStepCount();
+	}
+
+	return route;
+}
+
+void RoutePlanner::SetThreadCount(int count) {
+	threadCount = count;
+}
+
+int RoutePlanner::GetCachedLegCount() {
+	return (int)legs.size();
+}
+
+int RoutePlanner::GetDistanceSearchCount() {
+	return distanceSearches;
+}
+
+int RoutePlanner::GetLegSearchCount() {
+	return legSearches;
+}
+
+void RoutePlanner::ClearCache() {
+	legs.clear();
+}
+
+long long RoutePlanner::GetLegKey(Cell from, Cell to) {
+	long long cellCount = (long long)grid.GetGridX() * grid.GetGridY();
+	long long fromIndex = from.x + (long long)from.y * grid.GetGridX();
+	long long toIndex = to.x + (long long)to.y * grid.GetGridX();
+	return fromIndex * cellCount + toIndex;
+}
+
+void RoutePlanner::CacheDistances(const std::vector<Cell> &points) {
+	if ((int)(legs.size() + points.size() * points.size()) > maxCachedLegs)
+		ClearCache(); //Rather than tracking recency, start over once the cache gets this big
+
+	//Points that have never been planned with go first, their searches fill in most of the missing pairs
+	std::vector<bool> isSource = std::vector<bool>(points.size(), false);
+	for (int x = 0;x < points.size();x++)
+		isSource[x] = legs.find(GetLegKey(points[x], points[x])) == legs.end();
+
+	//Anything still missing a pair that no search will cover needs its own
+	for (int x = 0;x < points.size();x++) {
+		for (int y = 0;y < points.size() && !isSource[x];y++) {
+			if (!isSource[y] && legs.find(GetLegKey(points[x], points[y])) == legs.end())
+				isSource[x] = true;
+		}
+	}
+
+	std::vector<Cell> sources;
+	for (int x = 0;x < points.size();x++) {
+		if (isSource[x])
+			sources.push_back(points[x]);
+	}
+
+	if (sources.empty())
+		return;
+
+	DistanceMatrix matrix;
+	MapDistanceMatrix(grid, sources, points, matrix, threadCount, true);
+	distanceSearches += (int)sources.size();
+
+	//Moves are reversible and walled endpoints are entered and left the same way, so every distance also answers the reverse pair.
+	//That is what makes one new waypoint cost one search instead of one per waypoint.
+	for (int x = 0;x < sources.size();x++) {
+		for (int y = 0;y < points.size();y++) {
+			legs[GetLegKey(sources[x], points[y])].cost = matrix.Get(x, y);
+			legs[GetLegKey(points[y], sources[x])].cost = matrix.Get(x, y);
+		}
+	}
+}
+
+int RoutePlanner::GetDistance(const std::vector<Cell> &points, int from, int to) {
+	int cost = legs[GetLegKey(points[from], points[to])].cost;
+	return (cost < 0) ? unreachableCost : cost;
+}
+
+const EncodedPath &RoutePlanner::GetLegPath(Cell from, Cell to) {
+	Leg &leg = legs[GetLegKey(from, to)];
+	if (!leg.hasPath) {
+		if (MapAStarSearch(grid, from.x, from.y, to.x, to.y, scratch, legBuffer))
+			leg.path.EncodeIndices(grid.GetGridX(), (unsigned int)(from.x + from.y * grid.GetGridX()), legBuffer);
+		else
+			leg.path.Clear();
+		leg.hasPath = true;
+		legSearches++;
+	}
+
+	return leg.path;
+}
+
+long long RoutePlanner::GetTourCost(const std::vector<Cell> &points, const std::vector<int> &tour, bool closed) {
+	long long cost = 0;
+	for (int x = 1;x < tour.size();x++)
+		cost += GetDistance(points, tour[x - 1], tour[x]);
+
+	if (closed && tour.size() > 1)
+		cost += GetDistance(points, tour.back(), tour[0]);
+
+	return cost;
+}
+
+bool RoutePlanner::ImproveTwoOpt(const std::vector<Cell> &points, std::vector<int> &tour, bool closed) {
+	long long currentCost = GetTourCost(points, tour, closed);
+
+	//Reverse tour[i..j]. Grid distances are symmetric, so only the two edges at the ends of the segment change
+	for (int i = 1;i < (int)tour.size() - 1;i++) {
+		for (int j = i + 1;j < tour.size();j++) {
+			int before = tour[i - 1];
+			int first = tour[i];
+			int last = tour[j];
+			int after = (j + 1 < (int)tour.size()) ? tour[j + 1] : (closed ? tour[0] : -1);
+
+			long long removed = GetDistance(points, before, first) + ((after >= 0) ? GetDistance(points, last, after) : 0);
+			long long added = GetDistance(points, before, last) + ((after >= 0) ? GetDistance(points, first, after) : 0);
+			if (added >= removed)
+				continue;
+
+			std::reverse(tour.begin() + i, tour.begin() + j + 1);
+
+			//Double check against the full cost, in case a wall waypoint made a leg one-way
+			if (GetTourCost(points, tour, closed) < currentCost)
+				return true;
+
+			std::reverse(tour.begin() + i, tour.begin() + j + 1);
+		}
+	}
+
+	return false;
+}
+
+bool RoutePlanner::ImproveOrOpt(const std::vector<Cell> &points, std::vector<int> &tour, bool closed) {
+	long long currentCost = GetTourCost(points, tour, closed);
+
+	//Lift out 1 to 3 consecutive stops and try them between every other pair of neighbours
+	for (int length = 1;length <= 3;length++) {
+		for (int i = 1;i + length <= (int)tour.size();i++) {
+			std::vector<int> segment = std::vector<int>(tour.begin() + i, tour.begin() + i + length);
+			std::vector<int> rest = tour;
+			rest.erase(rest.begin() + i, rest.begin() + i + length);
+
+			int before = tour[i - 1];
+			int after = (i + length < (int)tour.size()) ? tour[i + length] : (closed ? tour[0] : -1);
+			long long saved = GetDistance(points, before, segment.front()) + ((after >= 0) ? GetDistance(points, segment.back(), after) : 0)
+				- ((after >= 0) ? GetDistance(points, before, after) : 0);
+
+			for (int k = 0;k < rest.size();k++) {
+				if (k == i - 1)
+					continue; //Where it came from
+
+				int left = rest[k];
+				int right = (k + 1 < (int)rest.size()) ? rest[k + 1] : (closed ? rest[0] : -1);
+				long long cost = GetDistance(points, left, segment.front()) + ((right >= 0) ? GetDistance(points, segment.back(), right) : 0)
+					- ((right >= 0) ? GetDistance(points, left, right) : 0);
+				if (cost >= saved)
+					continue;
+
+				std::vector<int> moved = rest;
+				moved.insert(moved.begin() + k + 1, segment.begin(), segment.end());
+				if (GetTourCost(points, moved, closed) < currentCost) {
+					tour = moved;
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+#endif
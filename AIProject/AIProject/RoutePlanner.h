@@ -0,0 +1,75 @@
+#ifndef ROUTEPLANNER_H
+#define ROUTEPLANNER_H
+
+#include "Cell.h"
+#include "DistanceMatrix.h"
+#include "Grid.h"
+#include "MapSearch.h"
+#include "PathEncoding.h"
+
+#include <unordered_map>
+#include <vector>
+
+/* A planned multi-waypoint route */
+class Route {
+public:
+	std::vector<Cell> order; /* The reachable waypoints in the order they are visited */
+	std::vector<Cell> path; /* Every cell walked from the start through each waypoint, excluding the start cell */
+	std::vector<Cell> unreachable; /* Waypoints with no path from the start, left out of the route */
+	int cost = 0; /* Total moves along path */
+};
+
+/*
+Plans routes from a start through several waypoints (patrols, deliveries), optionally returning to the start.
+	- Pairwise waypoint distances come from MapDistanceMatrix, one parallel BFS per waypoint
+	- The visiting order starts from a nearest-neighbour tour, improved with 2-opt and Or-opt moves until neither helps
+	- Leg paths are found with MapAStarSearch and stitched into one path
+Distances and leg paths are cached by cell pair, paths run-length encoded so a large cache stays small, so replanning after adding or removing a few waypoints
+only searches from the new ones. The cache is dropped whenever the grid's version changes.
+*/
+class RoutePlanner {
+public:
+	static const int maxCachedLegs = 1 << 16; /* The cache is cleared when it grows past this many legs */
+
+	RoutePlanner(Grid &grid); /* Plans over grid, which must outlive the planner */
+
+	Route PlanRoute(Cell start, const std::vector<Cell> &waypoints, bool returnToStart); /* Plans a route visiting every reachable waypoint */
+
+	void SetThreadCount(int count); /* Threads used for distance searches, 0 for the hardware thread count */
+	int GetCachedLegCount(); /* Returns how many cell pairs have a cached distance */
+	int GetDistanceSearchCount(); /* Returns how many BFS searches the planner has run */
+	int GetLegSearchCount(); /* Returns how many leg A* searches the planner has run */
+	void ClearCache(); /* Forgets every cached distance and leg path */
+private:
+	static const int unreachableCost = 1 << 20; /* Stands in for a missing path so tour costs stay comparable */
+
+	/* A cached distance between two cells, and the path once it has been needed */
+	class Leg {
+	public:
+		int cost = -1; /* -1 if there is no path */
+		bool hasPath = false;
+		EncodedPath path;
+	};
+
+	long long GetLegKey(Cell from, Cell to); /* Cache key of the pair */
+	void CacheDistances(const std::vector<Cell> &points); /* Makes sure every pair of points has a cached distance */
+	int GetDistance(const std::vector<Cell> &points, int from, int to); /* Cached distance, a large penalty if unreachable */
+	const EncodedPath &GetLegPath(Cell from, Cell to); /* Cached leg path, searching for it on first use */
+
+	long long GetTourCost(const std::vector<Cell> &points, const std::vector<int> &tour, bool closed);
+	bool ImproveTwoOpt(const std::vector<Cell> &points, std::vector<int> &tour, bool closed); /* Applies the first improving segment reversal. Returns false if none */
+	bool ImproveOrOpt(const std::vector<Cell> &points, std::vector<int> &tour, bool closed); /* Applies the first improving move of 1 to 3 consecutive stops. Returns false if none */
+
+	Grid &grid;
+	int threadCount = 0;
+	unsigned long long cachedVersion = 0; /* Grid version the cache was built against */
+	int cachedWidth = 0;
+	int cachedHeight = 0;
+	int distanceSearches = 0;
+	int legSearches = 0;
+	std::unordered_map<long long, Leg> legs;
+	SearchScratch scratch;
+	std::vector<unsigned int> legBuffer; /* Reused output of leg searches, before encoding */
+};
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef SAFEINTERVALPLANNER_CPP
+#define SAFEINTERVALPLANNER_CPP
+#include "SafeIntervalPlanner.h"
+
+bool MovingObstacle::GetPosition(int time, Cell &position) const {
+	if (path.empty() || time < startTime)
+		return false;
+
+	int step = time - startTime;
+	if (loops)
+		step %= (int)path.size();
+	else if (step >= (int)path.size())
+		step = (int)path.size() - 1; //Parked on its last cell
+
+	position = path[step];
+	return true;
+}
+
+void SafeIntervalPlanner::SetObstacles(const std::vector<MovingObstacle> &obstacles, int width, int height, int horizon) {
+	this->width = width;
+	this->height = height;
+	this->obstacles = obstacles;
+
+	//Every (cell, time) an obstacle passes through, packed as cell << 32 | time, and for each cell the earliest time something parks on it for good
+	std::vector<long long> occupied;
+	std::vector<int> parkedFrom = std::vector<int>(width * height, INT_MAX);
+	for (int x = 0;x < obstacles.size();x++) {
+		const MovingObstacle &obstacle = obstacles[x];
+		if (obstacle.path.empty())
+			continue;
+
+		int end = obstacle.loops ? horizon : std::min(horizon, obstacle.startTime + (int)obstacle.path.size() - 1);
+		for (int time = std::max(obstacle.startTime, 0);time <= end;time++) {
+			Cell position;
+			obstacle.GetPosition(time, position);
+			if (position.x >= 0 && position.x < width && position.y >= 0 && position.y < height)
+				occupied.push_back(((long long)(position.x + position.y * width) << 32) | (unsigned int)time);
+		}
+
+		if (!obstacle.loops) {
+			const Cell &last = obstacle.path.back();
+			if (last.x >= 0 && last.x < width && last.y >= 0 && last.y < height) {
+				int &cellParkedFrom = parkedFrom[last.x + last.y * width];
+				cellParkedFrom = std::min(cellParkedFrom, std::max(obstacle.startTime + (int)obstacle.path.size() - 1, 0));
+			}
+		}
+	}
+
+	std::sort(occupied.begin(), occupied.end());
+
+	//Turn each cell's sorted busy times into the gaps between them
+	firstInterval.assign(width * height + 1, 0);
+	intervals.clear();
+	intervalCell.clear();
+
+	int next = 0;
+	for (int cell = 0;cell < width * height;cell++) {
+		firstInterval[cell] = (int)intervals.size();
+
+		SafeInterval interval;
+		interval.start = 0;
+		int parked = parkedFrom[cell];
+
+		for (;next < occupied.size() && (int)(occupied[next] >> 32) == cell;next++) {
+			int time = (int)(occupied[next] & 0xFFFFFFFF);
+			if (time >= parked)
+				continue; //The cell is taken for good by then, passes after it don't split anything
+
+			if (time > interval.start) {
+				interval.end = time - 1;
+				intervals.push_back(interval);
+				intervalCell.push_back(cell);
+			}
+
+			interval.start = std::max(interval.start, time + 1);
+		}
+
+		//After the last pass the cell stays free, until something parks on it
+		if (interval.start < parked) {
+			interval.end = (parked == INT_MAX) ? INT_MAX : parked - 1;
+			intervals.push_back(interval);
+			intervalCell.push_back(cell);
+		}
+	}
+
+	firstInterval[width * height] = (int)intervals.size();
+}
+
+int SafeIntervalPlanner::GetIntervalCount(int x, int y) const {
+	if (x < 0 || x >= width || y < 0 || y >= height)
+		return 0;
+
+	int cell = x + y * width;
+	return firstInterval[cell + 1] - firstInterval[cell];
+}
+
+const SafeInterval &SafeIntervalPlanner::GetInterval(int x, int y, int interval) const {
+	return intervals[firstInterval[x + y * width] + interval];
+}
+
+int SafeIntervalPlanner::GetTotalIntervalCount() const {
+	return (int)intervals.size();
+}
+
+bool SafeIntervalPlanner::IsSwapBlocked(int fromX, int fromY, int toX, int toY, int departTime) const {
+	for (int x = 0;x < obstacles.size();x++) {
+		Cell before;
+		Cell after;
+		if (obstacles[x].GetPosition(departTime, before) && obstacles[x].GetPosition(departTime + 1, after)
+			&& before.x == toX && before.y == toY && after.x == fromX && after.y == fromY)
+			return true;
+	}
+
+	return false;
+}
+
+int SafeIntervalPlanner::GetArrivalTime(int fromX, int fromY, int toX, int toY, int earliest, int latestDepart, const SafeInterval &target) const {
+	//Arrive as early as both intervals allow, stepping past any moment an obstacle would swap cells with us
+	int time = std::max(earliest, target.start);
+	while (time <= target.end && time - 1 <= latestDepart) {
+		if (!IsSwapBlocked(fromX, fromY, toX, toY, time - 1))
+			return time;
+
+		time++;
+	}
+
+	return -1;
+}
+#endif
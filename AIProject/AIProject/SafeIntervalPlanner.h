@@ -0,0 +1,171 @@
+#ifndef SAFEINTERVALPLANNER_H
+#define SAFEINTERVALPLANNER_H
+
+#include "Cell.h"
+#include "Heuristics.h"
+#include "MapSearch.h"
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <vector>
+
+/* An obstacle moving along a known trajectory, one cell per time step */
+class MovingObstacle {
+public:
+	std::vector<Cell> path; /* Occupies path[t - startTime] at time t */
+	int startTime = 0; /* Before this the obstacle isn't on the grid */
+	bool loops = false; /* Starts over from path[0] after the last cell, otherwise it stays on the last cell forever */
+
+	bool GetPosition(int time, Cell &position) const; /* Where the obstacle is at time. Returns false if it isn't on the grid then */
+};
+
+/* A span of time steps, inclusive on both ends, during which a cell is free */
+class SafeInterval {
+public:
+	int start;
+	int end; /* INT_MAX when the cell stays free forever */
+};
+
+/* One stop of a timed path: the agent waits at the previous stop, then arrives here at time */
+class TimedWaypoint {
+public:
+	Cell cell;
+	int time;
+};
+
+/*
+Safe Interval Path Planning around moving obstacles with known schedules.
+SetObstacles turns the schedules into, for every cell, a sorted list of safe intervals stored back to back in one array.
+Plan then searches (cell, safe interval) states instead of (cell, time step) states. Waiting is folded into the moves,
+so a cell that is free all along costs exactly what it does in a plain A*, and the search only grows where obstacles pass.
+
+Looping obstacles are only expanded up to the horizon given to SetObstacles, plans that run past it may meet them.
+*/
+class SafeIntervalPlanner {
+public:
+	void SetObstacles(const std::vector<MovingObstacle> &obstacles, int width, int height, int horizon); /* Rebuilds the safe interval table for a width x height map */
+
+	int GetIntervalCount(int x, int y) const; /* Returns how many safe intervals (x, y) has */
+	const SafeInterval &GetInterval(int x, int y, int interval) const; /* Returns one of (x, y)'s safe intervals, in time order */
+	int GetTotalIntervalCount() const; /* Returns the size of the whole table */
+
+	/*
+	Earliest-arrival path from (startX, startY) at startTime to (goalX, goalY), moving 4-directionally or waiting in place.
+	Works on any map providing int GetGridX() const, int GetGridY() const and bool IsWalkable(int x, int y) const,
+	of the same size given to SetObstacles. The path never shares a cell with an obstacle at the same time step and never swaps cells with one.
+	Returns the cells where the agent arrives after a move, with arrival times, excluding the start. Empty if the goal can't be reached.
+	*/
+	template <typename Map>
+	std::vector<TimedWaypoint> Plan(const Map &map, int startX, int startY, int startTime, int goalX, int goalY, SearchScratch &scratch) const;
+private:
+	bool IsSwapBlocked(int fromX, int fromY, int toX, int toY, int departTime) const; /* True if an obstacle moves from (toX, toY) to (fromX, fromY) as the agent moves the other way */
+	int GetArrivalTime(int fromX, int fromY, int toX, int toY, int earliest, int latestDepart, const SafeInterval &target) const; /* Earliest safe arrival in target, -1 if none */
+
+	int width = 0;
+	int height = 0;
+	std::vector<MovingObstacle> obstacles;
+	std::vector<int> firstInterval; /* Cell (x + y * width) owns intervals[firstInterval[cell]] to intervals[firstInterval[cell + 1] - 1] */
+	std::vector<SafeInterval> intervals;
+	std::vector<int> intervalCell; /* The cell each interval belongs to */
+};
+
+template <typename Map>
+std::vector<TimedWaypoint> SafeIntervalPlanner::Plan(const Map &map, int startX, int startY, int startTime, int goalX, int goalY, SearchScratch &scratch) const {
+	std::vector<TimedWaypoint> path;
+	if (map.GetGridX() != width || map.GetGridY() != height)
+		return path;
+	if (startX < 0 || startX >= width || startY < 0 || startY >= height || goalX < 0 || goalX >= width || goalY < 0 || goalY >= height)
+		return path;
+
+	//States are interval indices, so the scratch is sized to the interval table rather than the grid
+	scratch.Begin((int)intervals.size());
+
+	int startCell = startX + startY * width;
+	int startState = -1;
+	for (int x = firstInterval[startCell];x < firstInterval[startCell + 1];x++) {
+		if (intervals[x].start <= startTime && startTime <= intervals[x].end)
+			startState = x;
+	}
+
+	if (startState == -1)
+		return path; //An obstacle is on the start right now
+
+	scratch.See(startState, startTime, -1);
+	scratch.open.push_back(((long long)(startTime + ManhattanDistance(startX, startY, goalX, goalY)) << 32) | startState);
+
+	const int offsetX[4] = { -1, 0, 1, 0 };
+	const int offsetY[4] = { 0, -1, 0, 1 };
+
+	while (!scratch.open.empty()) {
+		std::pop_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		int current = (int)(scratch.open.back() & 0xFFFFFFFF);
+		scratch.open.pop_back();
+
+		if (scratch.IsClosed(current))
+			continue;
+
+		scratch.Close(current);
+		scratch.expandedCells++;
+
+		int cell = intervalCell[current];
+		int currentX = cell % width;
+		int currentY = cell / width;
+		int arrival = scratch.g[current];
+
+		if (currentX == goalX && currentY == goalY) {
+			for (int state = current;state != startState;state = scratch.parent[state]) {
+				TimedWaypoint waypoint;
+				waypoint.cell = Cell(intervalCell[state] % width, intervalCell[state] / width);
+				waypoint.time = scratch.g[state];
+				path.push_back(waypoint);
+			}
+
+			if (path.empty()) {
+				TimedWaypoint waypoint;
+				waypoint.cell = Cell(startX, startY);
+				waypoint.time = startTime;
+				path.push_back(waypoint);
+			}
+
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
+
+		if (cell != startCell && !map.IsWalkable(currentX, currentY))
+			continue;
+
+		//The agent may wait here until the end of this interval, so it can leave any time up to then
+		int latestDepart = intervals[current].end;
+
+		for (int direction = 0;direction < 4;direction++) {
+			int x = currentX + offsetX[direction];
+			int y = currentY + offsetY[direction];
+			if (x < 0 || x >= width || y < 0 || y >= height)
+				continue;
+			if ((x != goalX || y != goalY) && !map.IsWalkable(x, y))
+				continue;
+
+			int neighbor = x + y * width;
+			for (int state = firstInterval[neighbor];state < firstInterval[neighbor + 1];state++) {
+				if (scratch.IsClosed(state))
+					continue;
+				if (intervals[state].start - 1 > latestDepart)
+					break; //Later intervals open even further past the time we have to leave
+
+				int time = GetArrivalTime(currentX, currentY, x, y, arrival + 1, latestDepart, intervals[state]);
+				if (time < 0 || (scratch.IsSeen(state) && scratch.g[state] <= time))
+					continue;
+
+				scratch.See(state, time, current);
+				long long f = time + ManhattanDistance(x, y, goalX, goalY);
+				scratch.open.push_back((f << 32) | state);
+				std::push_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+			}
+		}
+	}
+
+	return path;
+}
+
+#endif
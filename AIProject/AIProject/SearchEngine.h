@@ -0,0 +1,282 @@
+#ifndef SEARCHENGINE_H
+#define SEARCHENGINE_H
+
+#include "Grid.h"
+#include "Heuristics.h"
+#include "SearchArena.h"
+
+#include <deque>
+#include <queue>
+#include <stack>
+#include <vector>
+
+/* A cell waiting on an open list: where it is stored in the grid, its position, and its heuristic estimate, which never changes during a search */
+class OpenEntry {
+public:
+	OpenEntry(int index, int x, int y, int h) : index(index), x(x), y(y), h(h) {}
+
+	int index;
+	int x;
+	int y;
+	int h;
+};
+
+typedef std::deque<OpenEntry, ArenaAllocator<OpenEntry>> ArenaEntryDeque;
+typedef std::vector<OpenEntry, ArenaAllocator<OpenEntry>> ArenaEntryVector;
+
+/*
+Open lists. Each holds entries for pushed cells and, on Pop, returns the chosen one, reading g from the search's cost table
+(indexed like the grid) so priorities always use a cell's current g.
+Their storage comes from the SearchArena they are made with, never from the global heap directly.
+*/
+
+/* Last in, first out. Makes the engine a depth first search */
+class StackOpenList {
+public:
+	StackOpenList(SearchArena &arena) : fringe(ArenaEntryDeque(ArenaAllocator<OpenEntry>(arena))) {}
+	void Push(const OpenEntry &entry) { fringe.push(entry); }
+	bool IsEmpty() const { return fringe.empty(); }
+	OpenEntry Pop(const int *costs) { OpenEntry top = fringe.top(); fringe.pop(); return top; }
+private:
+	std::stack<OpenEntry, ArenaEntryDeque> fringe;
+};
+
+/* First in, first out. Makes the engine a breadth first search */
+class QueueOpenList {
+public:
+	QueueOpenList(SearchArena &arena) : fringe(ArenaEntryDeque(ArenaAllocator<OpenEntry>(arena))) {}
+	void Push(const OpenEntry &entry) { fringe.push(entry); }
+	bool IsEmpty() const { return fringe.empty(); }
+	OpenEntry Pop(const int *costs) { OpenEntry front = fringe.front(); fringe.pop(); return front; }
+private:
+	std::queue<OpenEntry, ArenaEntryDeque> fringe;
+};
+
+/* Lowest h first, the most recently pushed on ties. Makes the engine a greedy best first search */
+class LowestHOpenList {
+public:
+	LowestHOpenList(SearchArena &arena) : fringe(ArenaAllocator<OpenEntry>(arena)) {}
+	void Push(const OpenEntry &entry) { fringe.push_back(entry); }
+	bool IsEmpty() const { return fringe.empty(); }
+	OpenEntry Pop(const int *costs) {
+		int best = 0;
+		for (int x = 1;x < fringe.size();x++) {
+			if (fringe[best].h >= fringe[x].h)
+				best = x;
+		}
+
+		OpenEntry current = fringe[best];
+		fringe.erase(fringe.begin() + best);
+		return current;
+	}
+private:
+	ArenaEntryVector fringe;
+};
+
+/* Lowest g + h first, the earliest pushed on ties. Makes the engine an A* search */
+class LowestFOpenList {
+public:
+	LowestFOpenList(SearchArena &arena) : fringe(ArenaAllocator<OpenEntry>(arena)) {}
+	void Push(const OpenEntry &entry) { fringe.push_back(entry); }
+	bool IsEmpty() const { return fringe.empty(); }
+	OpenEntry Pop(const int *costs) {
+		int best = 0;
+		for (int x = 1;x < fringe.size();x++) {
+			if (costs[fringe[best].index] + fringe[best].h > costs[fringe[x].index] + fringe[x].h)
+				best = x;
+		}
+
+		OpenEntry current = fringe[best];
+		fringe.erase(fringe.begin() + best);
+		return current;
+	}
+private:
+	ArenaEntryVector fringe;
+};
+
+/* Heuristics, estimating the cost from (x, y) to the goal */
+
+/* No estimate, for the uninformed searches */
+class ZeroHeuristic {
+public:
+	static int Estimate(int x, int y, int goalX, int goalY) { return 0; }
+};
+
+/* Moves needed on a 4-connected grid, exact on open ground */
+class ManhattanHeuristic {
+public:
+	static int Estimate(int x, int y, int goalX, int goalY) { return ManhattanDistance(x, y, goalX, goalY); }
+};
+
+/* Straight line distance, rounded down */
+class EuclideanHeuristic {
+public:
+	static int Estimate(int x, int y, int goalX, int goalY) { return EuclideanDistance(x, y, goalX, goalY); }
+};
+
+/* Neighbor models, calling visit(neighborX, neighborY) on every cell reachable in one move from (x, y) */
+
+/* Left, up, right, down, keeping floor tiles and the goal, through Grid::ForEachValidNeighbor */
+class FourWayNeighbors {
+public:
+	template <typename Visit>
+	static void ForEach(const Grid &grid, int x, int y, Visit visit) { grid.ForEachValidNeighbor(x, y, visit); }
+};
+
+/* Cost models, pricing a single move */
+
+/* Every move costs 1 */
+class UnitCost {
+public:
+	static int GetStepCost(int fromX, int fromY, int toX, int toY) { return 1; }
+};
+
+/* Path sinks, receiving a found path of length cells through Begin(length) and then Set(position, cell) for each position */
+
+/* Whole Cells, the shape Grid's searches have always returned */
+class CellPathSink {
+public:
+	CellPathSink(std::vector<Cell> &path) : path(path) {}
+	void Begin(int length) { path.resize(length); }
+	void Set(int position, const Cell &cell) { path[position] = cell; }
+private:
+	std::vector<Cell> &path;
+};
+
+/* Packed 32-bit indices, x + y * width, written over the caller's buffer so its memory is reused */
+class IndexPathSink {
+public:
+	IndexPathSink(std::vector<unsigned int> &path, int width) : path(path), width(width) {}
+	void Begin(int length) { path.resize(length); }
+	void Set(int position, const Cell &cell) { path[position] = (unsigned int)(cell.x + cell.y * width); }
+private:
+	std::vector<unsigned int> &path;
+	int width;
+};
+
+/*
+The search loop shared by every Grid search, from the grid's start position to its goal position.
+The policies are plain classes resolved at compile time, so each combination compiles to its own fully inlined loop
+with no virtual calls or function pointers:
+	OpenList decides which cell is expanded next,
+	Heuristic fills in h when a cell is pushed,
+	NeighborModel decides which cells a cell leads to,
+	CostModel fills in g as the parent's g plus the step cost.
+A cell is expanded at most once, and its parent is whichever cell pushed it last.
+Honors the grid's cancellation token and diagnostics flags, and leaves every cell's visited flag cleared.
+The open list and the g of every cell live in the calling thread's SearchArena, so once that has warmed up the only global heap
+allocation a search makes is the path, sized once, and none at all when the sink reuses a caller's buffer.
+*/
+template <typename OpenList, typename Heuristic, typename NeighborModel, typename CostModel>
+class SearchEngine {
+public:
+	static std::vector<Cell> Run(Grid &grid) {
+		std::vector<Cell> path;
+		CellPathSink sink(path);
+		Run(grid, sink);
+		return path;
+	}
+
+	template <typename PathSink>
+	static bool Run(Grid &grid, PathSink &path) { /* Hands a found path to path and returns true. Returns false, without touching path, if there is none */
+		std::vector<unsigned char> &cells = grid.cells;
+
+		//Searches don't nest, so whatever the last one on this thread left behind is garbage by now
+		SearchArena &arena = SearchArena::ForThisThread();
+		arena.Reset();
+
+		//Never cleared, a cell's cost is only read after the push that wrote it
+		int *costs = (int *)arena.Allocate(cells.size() * sizeof(int));
+
+		int startX = grid.startPos.x;
+		int startY = grid.startPos.y;
+		int goalX = grid.goalPos.x;
+		int goalY = grid.goalPos.y;
+
+		OpenList fringe(arena);
+		costs[grid.GetIndex(startX, startY)] = 0;
+		fringe.Push(OpenEntry(grid.GetIndex(startX, startY), startX, startY, Heuristic::Estimate(startX, startY, goalX, goalY)));
+
+		int totalTraversedCells = 0;
+		grid.lastSearchCancelled = false;
+
+		//Loop until we have no other possible ways to move
+		while (!fringe.IsEmpty()) {
+			OpenEntry current = fringe.Pop(costs);
+
+			//A cell can be on the fringe more than once, only its first pop counts
+			if (cells[current.index] & Grid::visitedFlag)
+				continue;
+
+			cells[current.index] |= Grid::visitedFlag; //Mark this cell as visited
+			totalTraversedCells++;
+
+			//Abandon the search if the caller no longer wants the answer
+			if (grid.cancellationToken != nullptr && grid.cancellationToken->ShouldStop(totalTraversedCells)) {
+				grid.lastSearchCancelled = true;
+				grid.ResetCellSearchSettings(); //Reset all grid cells to be not-visited
+				return false;
+			}
+
+			if (cells[current.index] & Grid::goalFlag) {
+				if (grid.displayAllTraversedCells)
+					std::cout << "(" << current.x << ", " << current.y << ")[Goal]";
+
+				if (grid.outputSearchDiagnostics)
+					std::cout << "\n\nTotal Visited Cells: " << totalTraversedCells;
+
+				//If the goal is the start, it has no parent. Simply return the current cell as the path.
+				//Otherwise, measure the trail of parent directions back to the start, then fill it in from the goal end so it comes out in order
+				int length = 0;
+				for (int x = current.x, y = current.y;x != startX || y != startY;length++) {
+					int direction = grid.GetParentDirection(grid.GetIndex(x, y));
+					x += Grid::GetDirectionX(direction);
+					y += Grid::GetDirectionY(direction);
+				}
+
+				path.Begin(std::max(length, 1));
+				int x = current.x;
+				int y = current.y;
+				for (int position = std::max(length, 1) - 1;position >= 0;position--) {
+					Cell step = grid.ReadCell(x, y);
+					step.g = costs[grid.GetIndex(x, y)];
+					step.h = Heuristic::Estimate(x, y, goalX, goalY);
+					path.Set(position, step);
+
+					int direction = grid.GetParentDirection(grid.GetIndex(x, y));
+					x += Grid::GetDirectionX(direction);
+					y += Grid::GetDirectionY(direction);
+				}
+
+				grid.ResetCellSearchSettings(); //Reset all grid cells to be not-visited
+				return true;
+			}
+
+			if (grid.displayAllTraversedCells)
+				std::cout << "(" << current.x << ", " << current.y << ") -> ";
+
+			int currentCost = costs[current.index];
+			NeighborModel::ForEach(grid, current.x, current.y, [&](int neighborX, int neighborY) {
+				//If we haven't visited the cell, point its parent at this cell, and push it onto the fringe
+				int neighbor = grid.GetIndex(neighborX, neighborY);
+				if (!(cells[neighbor] & Grid::visitedFlag)) {
+					grid.SetParentDirection(neighbor, Grid::GetDirection(current.x - neighborX, current.y - neighborY));
+					costs[neighbor] = currentCost + CostModel::GetStepCost(current.x, current.y, neighborX, neighborY);
+					fringe.Push(OpenEntry(neighbor, neighborX, neighborY, Heuristic::Estimate(neighborX, neighborY, goalX, goalY)));
+				}
+			});
+		}
+
+		if (grid.outputSearchDiagnostics)
+			std::cout << "\n\nTotal Visited Cells: " << totalTraversedCells;
+		grid.ResetCellSearchSettings(); //Reset all grid cells to be not-visited
+		return false;
+	}
+};
+
+typedef SearchEngine<StackOpenList, ZeroHeuristic, FourWayNeighbors, UnitCost> DepthFirstEngine;
+typedef SearchEngine<QueueOpenList, ZeroHeuristic, FourWayNeighbors, UnitCost> BreadthFirstEngine;
+typedef SearchEngine<LowestHOpenList, EuclideanHeuristic, FourWayNeighbors, UnitCost> GreedyEngine;
+typedef SearchEngine<LowestFOpenList, EuclideanHeuristic, FourWayNeighbors, UnitCost> AStarEngine;
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef SEARCHFUTURE_H
+#define SEARCHFUTURE_H
+
+#include "Grid.h"
+#include "PathQuery.h"
+#include "CancellationToken.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+class QueryScheduler;
+
+/* The state shared between a SearchFuture and whoever produces its result */
+class SearchState {
+public:
+	void Complete(PathQueryResult result); /* Stores the result, wakes waiters and runs the continuation if one is set */
+	bool SetContinuation(std::function<void()> continuation); /* Runs continuation on completion. Returns false, without storing it, if already complete */
+
+	std::mutex mutex;
+	std::condition_variable readyCondition; /* Signalled by Complete */
+	bool ready = false; /* True once result is set */
+	PathQueryResult result; /* Only valid once ready is true */
+	std::function<void()> continuation; /* Called once, on the completing thread */
+	std::shared_ptr<CancellationToken> cancellationToken; /* Cancels the search this state belongs to */
+};
+
+/*
+The pending result of a search running on another thread.
+Besides blocking waits it implements await_ready, await_suspend and await_resume,
+so it can be co_awaited directly from a C++20 coroutine. The coroutine resumes on the thread that finished the search.
+*/
+class SearchFuture {
+public:
+	SearchFuture(); /* An empty future, IsValid returns false */
+	SearchFuture(std::shared_ptr<SearchState> state); /* A future observing state */
+
+	bool IsValid(); /* Returns true if this future is attached to a search */
+	bool IsReady(); /* Returns true if the result is available */
+	void Wait(); /* Blocks until the result is available */
+	bool WaitFor(std::chrono::steady_clock::duration timeout); /* Blocks until the result is available or timeout passes. Returns IsReady */
+	PathQueryResult Get(); /* Blocks until the result is available, then returns a copy of it */
+
+	void Cancel(); /* Asks the search to stop. The result will have the cancelled status unless it already finished */
+	std::shared_ptr<CancellationToken> GetCancellationToken(); /* Returns the token shared with the search */
+
+	bool await_ready(); /* Coroutine support, true if no suspension is needed */
+	template <typename Handle>
+	bool await_suspend(Handle handle); /* Coroutine support, resumes handle once the search finishes */
+	PathQueryResult await_resume(); /* Coroutine support, returns the result */
+private:
+	std::shared_ptr<SearchState> state;
+};
+
+template <typename Handle>
+bool SearchFuture::await_suspend(Handle handle) {
+	//If the search finished in between await_ready and here, don't suspend at all
+	return state->SetContinuation([handle]() mutable { handle.resume(); });
+}
+
+/*
+Searches the scheduler's grid from start to goal with exactly the given algorithm, on one of the scheduler's workers.
+Rejected or shut down queries still complete the future, with the matching status.
+*/
+SearchFuture SearchAsync(QueryScheduler &scheduler, Cell start, Cell goal, SearchAlgorithm algorithm);
+SearchFuture SearchAsync(QueryScheduler &scheduler, Cell start, Cell goal, SearchAlgorithm algorithm, std::chrono::steady_clock::duration timeout); /* Same as above, the search gives up after timeout */
+
+#endif
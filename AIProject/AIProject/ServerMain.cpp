@@ -0,0 +1,123 @@
+#include "Grid.h"
+#include "PathServer.h"
+#include "SharedGrid.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <stdio.h>
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <signal.h>
+#endif
+
+static const char *usage = "Usage: PathServer <grid file> [--socket <path>] [--workers <n>] [--batch <n>] [--window-us <n>] [--publish <name>]";
+
+/* Reads text as a whole non-negative int into value. Returns false, leaving value alone, if it is anything else */
+static bool ParseCount(const char *text, int &value) {
+	char *end = nullptr;
+	errno = 0;
+	long parsed = strtol(text, &end, 10);
+	if (end == text || *end != '\0' || errno == ERANGE || parsed < 0 || parsed > INT_MAX)
+		return false;
+
+	value = (int)parsed;
+	return true;
+}
+
+/*
+Headless entry point, serving path queries for a single grid file without the console UI.
+Usage: PathServer <grid file> [--socket <path>] [--workers <n>] [--batch <n>] [--window-us <n>] [--publish <name>]
+Without --socket, requests are read from stdin and responses written to stdout.
+With --publish, the grid's tiles are also placed in a shared-memory segment that other processes can attach to read-only.
+*/
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		std::cerr << usage << std::endl;
+		return 1;
+	}
+
+	std::string socketPath;
+	int workers = 0;
+	int batchSize = 64;
+	int windowMicroseconds = 500;
+	std::string publishName;
+
+	for (int x = 2;x < argc;x += 2) {
+		std::string option = argv[x];
+		if (x + 1 == argc) {
+			std::cerr << "Missing value for " << option << std::endl;
+			std::cerr << usage << std::endl;
+			return 1;
+		}
+
+		bool valid = true;
+		if (option == "--socket")
+			socketPath = argv[x + 1];
+		else if (option == "--workers")
+			valid = ParseCount(argv[x + 1], workers);
+		else if (option == "--batch")
+			valid = ParseCount(argv[x + 1], batchSize);
+		else if (option == "--window-us")
+			valid = ParseCount(argv[x + 1], windowMicroseconds);
+		else if (option == "--publish")
+			publishName = argv[x + 1];
+		else {
+			std::cerr << "Unknown option " << option << std::endl;
+			std::cerr << usage << std::endl;
+			return 1;
+		}
+
+		if (!valid) {
+			std::cerr << "Expected a non-negative number after " << option << ", got " << argv[x + 1] << std::endl;
+			std::cerr << usage << std::endl;
+			return 1;
+		}
+	}
+
+	//Load the grid once, every client shares this warm instance
+	std::ifstream file(argv[1]);
+	Grid grid;
+	if (!file || !grid.LoadGrid(file)) {
+		std::cerr << "Unable to load a grid from " << argv[1] << std::endl;
+		return 1;
+	}
+
+	//Share the tiles with worker processes on this machine for as long as the server runs
+	SharedGrid sharedGrid;
+	if (!publishName.empty() && !sharedGrid.Publish(publishName, grid)) {
+		std::cerr << "Unable to publish the grid as " << publishName << std::endl;
+		return 1;
+	}
+
+#ifdef _WIN32
+	//stdin and stdout carry binary data, don't let the C runtime translate line endings
+	_setmode(_fileno(stdin), _O_BINARY);
+	_setmode(_fileno(stdout), _O_BINARY);
+#else
+	signal(SIGPIPE, SIG_IGN); //A client hanging up early shouldn't take the server down with it
+#endif
+
+	//Without --workers, run one worker per hardware thread
+	if (workers == 0)
+		workers = (int)std::thread::hardware_concurrency();
+
+	PathServer server(grid, workers);
+	server.SetMaxBatchSize(batchSize);
+	server.SetBatchWindow(std::chrono::microseconds(windowMicroseconds));
+
+	if (socketPath.empty()) {
+		server.ServeStreams(0, 1);
+	} else if (!server.ServeUnixSocket(socketPath)) {
+		std::cerr << "Unable to listen on " << socketPath << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
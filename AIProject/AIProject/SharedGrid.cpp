@@ -0,0 +1,292 @@
+#ifndef SHAREDGRID_CPP
+#define SHAREDGRID_CPP
+#include "SharedGrid.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <string.h>
+#include <atomic>
+
+/* Rounds offset up to the next multiple of 64, keeping every section on its own cache line */
+static uint64_t AlignOffset(uint64_t offset) {
+	return (offset + 63) & ~(uint64_t)63;
+}
+
+/* Segment names are global to the machine, give them the prefix each platform expects */
+/* Returns true if size bytes at offset fit inside limit bytes, without overflowing */
+static bool IsExtentInside(uint64_t offset, uint64_t size, uint64_t limit) {
+	return offset <= limit && size <= limit - offset;
+}
+
+static std::string GetPlatformName(const std::string &name) {
+#ifdef _WIN32
+	return "Local\\" + name;
+#else
+	return (name.size() > 0 && name[0] == '/') ? name : "/" + name;
+#endif
+}
+
+SharedGrid::SharedGrid() {
+}
+
+SharedGrid::~SharedGrid() {
+	Detach();
+}
+
+bool SharedGrid::Publish(const std::string &name, Grid &grid) {
+	return Publish(name, grid, std::vector<SharedTable>());
+}
+
+bool SharedGrid::Publish(const std::string &name, Grid &grid, const std::vector<SharedTable> &tables) {
+	Detach();
+
+	int width = grid.GetGridX();
+	int height = grid.GetGridY();
+
+	//Lay the segment out before creating it, so it can be created at its final size
+	uint64_t tilesOffset = AlignOffset(sizeof(Header));
+	uint64_t directoryOffset = AlignOffset(tilesOffset + (uint64_t)width * height);
+	uint64_t dataOffset = AlignOffset(directoryOffset + sizeof(TableEntry) * tables.size());
+
+	std::vector<uint64_t> tableOffsets;
+	for (int x = 0;x < tables.size();x++) {
+		if (tables[x].name.size() >= sizeof(TableEntry().name))
+			return false;
+
+		tableOffsets.push_back(dataOffset);
+		dataOffset = AlignOffset(dataOffset + tables[x].size);
+	}
+
+	if (!Map(name, (size_t)dataOffset, true))
+		return false;
+
+	//Tiles, row-major
+	for (int y = 0;y < height;y++) {
+		for (int x = 0;x < width;x++) {
+			base[tilesOffset + x + (uint64_t)y * width] = (unsigned char)grid.GetCell(x, y).tileType;
+		}
+	}
+
+	//Table directory and data
+	TableEntry *directory = (TableEntry *)(base + directoryOffset);
+	for (int x = 0;x < tables.size();x++) {
+		memset(&directory[x], 0, sizeof(TableEntry));
+		memcpy(directory[x].name, tables[x].name.data(), tables[x].name.size()); //Already zeroed, so this stays terminated
+		directory[x].offset = tableOffsets[x];
+		directory[x].size = tables[x].size;
+
+		if (tables[x].size > 0)
+			memcpy(base + tableOffsets[x], tables[x].data, tables[x].size);
+	}
+
+	//Write the header last, readers check the magic value to know the segment is complete
+	Header header;
+	memset(&header, 0, sizeof(Header));
+	header.formatVersion = currentFormatVersion;
+	header.width = width;
+	header.height = height;
+	header.startX = grid.GetStartPos().x;
+	header.startY = grid.GetStartPos().y;
+	header.goalX = grid.GetGoalPos().x;
+	header.goalY = grid.GetGoalPos().y;
+	header.tilesOffset = tilesOffset;
+	header.tableCount = tables.size();
+	header.directoryOffset = directoryOffset;
+	header.segmentSize = dataOffset;
+	memcpy(base, &header, sizeof(Header));
+
+	std::atomic_thread_fence(std::memory_order_release);
+	((volatile Header *)base)->magic = magicValue;
+
+	return true;
+}
+
+bool SharedGrid::Attach(const std::string &name) {
+	Detach();
+
+	if (!Map(name, 0, false))
+		return false;
+
+	const Header *header = GetHeader();
+	if (mappedSize < sizeof(Header) || header->magic != magicValue) {
+		Detach();
+		return false;
+	}
+
+	std::atomic_thread_fence(std::memory_order_acquire); //Pairs with the fence before Publish sets the magic value
+
+	//Reject anything that isn't a complete segment of a format we understand: every section has to lie inside the segment
+	uint64_t limit = header->segmentSize;
+	bool valid = header->formatVersion == currentFormatVersion && limit <= mappedSize && header->width >= 0 && header->height >= 0
+		&& IsExtentInside(header->tilesOffset, (uint64_t)header->width * header->height, limit)
+		&& header->directoryOffset <= limit && header->tableCount <= (limit - header->directoryOffset) / sizeof(TableEntry);
+
+	const TableEntry *directory = (const TableEntry *)(base + (valid ? header->directoryOffset : 0));
+	for (uint64_t x = 0;valid && x < header->tableCount;x++) {
+		valid = memchr(directory[x].name, '\0', sizeof(directory[x].name)) != nullptr //GetTable needs terminated names
+			&& IsExtentInside(directory[x].offset, directory[x].size, limit);
+	}
+
+	if (!valid) {
+		Detach();
+		return false;
+	}
+
+	return true;
+}
+
+void SharedGrid::Detach() {
+	if (base == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(base);
+	CloseHandle((HANDLE)mappingHandle);
+	mappingHandle = nullptr;
+#else
+	munmap(base, mappedSize);
+	if (publisher)
+		shm_unlink(GetPlatformName(segmentName).c_str());
+#endif
+
+	base = nullptr;
+	mappedSize = 0;
+	publisher = false;
+	segmentName.clear();
+}
+
+bool SharedGrid::IsAttached() const {
+	return base != nullptr;
+}
+
+int SharedGrid::GetGridX() const {
+	return (base != nullptr) ? GetHeader()->width : 0;
+}
+
+int SharedGrid::GetGridY() const {
+	return (base != nullptr) ? GetHeader()->height : 0;
+}
+
+Tile SharedGrid::GetTile(int x, int y) const {
+	if (base == nullptr)
+		return Tile::wall;
+
+	const Header *header = GetHeader();
+	if (x < 0 || x >= header->width || y < 0 || y >= header->height) //Outside of the grid is treated like the outer walls
+		return Tile::wall;
+
+	return (Tile)base[header->tilesOffset + x + (uint64_t)y * header->width];
+}
+
+bool SharedGrid::IsWalkable(int x, int y) const {
+	return GetTile(x, y) == Tile::floor;
+}
+
+const unsigned char *SharedGrid::GetTiles() const {
+	return (base != nullptr) ? base + GetHeader()->tilesOffset : nullptr;
+}
+
+Cell SharedGrid::GetStartPos() const {
+	return (base != nullptr) ? Cell(GetHeader()->startX, GetHeader()->startY) : Cell(-1, -1);
+}
+
+Cell SharedGrid::GetGoalPos() const {
+	return (base != nullptr) ? Cell(GetHeader()->goalX, GetHeader()->goalY) : Cell(-1, -1);
+}
+
+const void *SharedGrid::GetTable(const std::string &name, size_t &size) const {
+	size = 0;
+	if (base == nullptr || name.size() >= sizeof(TableEntry().name))
+		return nullptr;
+
+	const Header *header = GetHeader();
+	const TableEntry *directory = (const TableEntry *)(base + header->directoryOffset);
+
+	for (uint64_t x = 0;x < header->tableCount;x++) {
+		if (strncmp(name.c_str(), directory[x].name, sizeof(directory[x].name)) == 0) {
+			size = (size_t)directory[x].size;
+			return base + directory[x].offset;
+		}
+	}
+
+	return nullptr;
+}
+
+size_t SharedGrid::GetSegmentSize() const {
+	return mappedSize;
+}
+
+bool SharedGrid::Map(const std::string &name, size_t size, bool create) {
+	std::string platformName = GetPlatformName(name);
+
+#ifdef _WIN32
+	HANDLE handle;
+	if (create) {
+		handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)(size & 0xFFFFFFFF), platformName.c_str());
+	} else {
+		handle = OpenFileMappingA(FILE_MAP_READ, FALSE, platformName.c_str());
+	}
+	if (handle == nullptr)
+		return false;
+
+	void *view = MapViewOfFile(handle, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		CloseHandle(handle);
+		return false;
+	}
+
+	//Attaching doesn't know the size up front, ask the view for it
+	MEMORY_BASIC_INFORMATION info;
+	VirtualQuery(view, &info, sizeof(info));
+
+	mappingHandle = handle;
+	base = (unsigned char *)view;
+	mappedSize = create ? size : (size_t)info.RegionSize;
+#else
+	int fd;
+	if (create) {
+		shm_unlink(platformName.c_str()); //Replace a segment left behind by a publisher that crashed
+		fd = shm_open(platformName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+		if (fd >= 0 && ftruncate(fd, (off_t)size) != 0) {
+			close(fd);
+			shm_unlink(platformName.c_str());
+			return false;
+		}
+	} else {
+		fd = shm_open(platformName.c_str(), O_RDONLY, 0);
+		struct stat info;
+		if (fd >= 0 && fstat(fd, &info) == 0)
+			size = (size_t)info.st_size;
+	}
+	if (fd < 0 || size == 0) {
+		if (fd >= 0)
+			close(fd);
+		return false;
+	}
+
+	void *view = mmap(nullptr, size, create ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+	close(fd); //The mapping keeps the segment alive on its own
+	if (view == MAP_FAILED)
+		return false;
+
+	base = (unsigned char *)view;
+	mappedSize = size;
+#endif
+
+	segmentName = name;
+	publisher = create;
+	return true;
+}
+
+const SharedGrid::Header *SharedGrid::GetHeader() const {
+	return (const Header *)base;
+}
+#endif
@@ -0,0 +1,90 @@
+#ifndef SHAREDGRID_H
+#define SHAREDGRID_H
+
+#include "Cell.h"
+#include "Grid.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/* A named block of precomputed data to publish alongside the grid's tiles */
+class SharedTable {
+public:
+	std::string name; /* Up to 31 characters, used to look the table up with GetTable */
+	const void *data = nullptr; /* Copied into the segment by Publish */
+	size_t size = 0; /* Size of data in bytes */
+};
+
+/*
+A grid's tiles and precomputed tables, placed in a named shared-memory segment
+(POSIX shared memory, or a named file mapping on Windows) so several processes can read one copy.
+
+The segment only contains offsets from its own start, never pointers, so it is valid wherever it gets mapped:
+	header | tiles (width * height bytes, row-major, Tile values) | table directory | table data
+Sections are 64-byte aligned. One process Publishes, any number of others Attach read-only.
+An attached SharedGrid satisfies the map interface MapAStarSearch expects, so it can be searched without copying it.
+*/
+class SharedGrid {
+public:
+	SharedGrid(); /* Creates a SharedGrid that is neither published nor attached */
+	~SharedGrid(); /* Detaches. A publisher also removes the segment's name */
+
+	bool Publish(const std::string &name, Grid &grid); /* Publishes grid's tiles. Returns false if the segment couldn't be created */
+	bool Publish(const std::string &name, Grid &grid, const std::vector<SharedTable> &tables); /* Publishes grid's tiles plus tables */
+	bool Attach(const std::string &name); /* Maps a published segment read-only. Returns false if missing, or if its header, tiles, directory or any table lies outside it */
+	void Detach(); /* Unmaps the segment, removing its name if this SharedGrid published it */
+	bool IsAttached() const; /* Returns true if a segment is mapped */
+
+	/* The getters below answer as if for an empty grid when no segment is attached: 0 sizes, walls, nullptr and (-1, -1) */
+	int GetGridX() const; /* Returns the grid's width */
+	int GetGridY() const; /* Returns the grid's height */
+	Tile GetTile(int x, int y) const; /* Returns the tile at (x, y), or a wall if out of bounds */
+	bool IsWalkable(int x, int y) const; /* Returns true if (x, y) is in bounds and a floor tile */
+	const unsigned char *GetTiles() const; /* Returns the row-major tile bytes, x + y * GetGridX() */
+	Cell GetStartPos() const; /* Returns the start position the grid had when published */
+	Cell GetGoalPos() const; /* Returns the goal position the grid had when published */
+
+	const void *GetTable(const std::string &name, size_t &size) const; /* Returns a published table and its size, or nullptr if there is none by that name */
+	size_t GetSegmentSize() const; /* Returns the size of the whole mapped segment in bytes */
+private:
+	/* Fixed-size header at the very start of the segment */
+	class Header {
+	public:
+		uint32_t magic;
+		uint32_t formatVersion;
+		int32_t width;
+		int32_t height;
+		int32_t startX;
+		int32_t startY;
+		int32_t goalX;
+		int32_t goalY;
+		uint64_t tilesOffset;
+		uint64_t tableCount;
+		uint64_t directoryOffset;
+		uint64_t segmentSize;
+	};
+
+	/* One entry of the table directory */
+	class TableEntry {
+	public:
+		char name[32];
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	static const uint32_t magicValue = 0x52474941; /* "AIGR" */
+	static const uint32_t currentFormatVersion = 1;
+
+	bool Map(const std::string &name, size_t size, bool create); /* Opens or creates the named segment and maps it */
+	const Header *GetHeader() const;
+
+	unsigned char *base = nullptr; /* Start of the mapped segment */
+	size_t mappedSize = 0;
+	std::string segmentName;
+	bool publisher = false; /* True if this SharedGrid created the segment */
+	void *mappingHandle = nullptr; /* The file mapping handle on Windows, unused elsewhere */
+};
+
+#endif
@@ -0,0 +1,290 @@
+#ifndef VERSIONEDGRID_CPP
+#define VERSIONEDGRID_CPP
+#include "VersionedGrid.h"
+
+#include <functional>
+#include <thread>
+
+int GridSnapshot::GetGridX() const {
+	return width;
+}
+
+int GridSnapshot::GetGridY() const {
+	return height;
+}
+
+Tile GridSnapshot::GetTile(int x, int y) const {
+	if (x < 0 || x >= width || y < 0 || y >= height) //Outside of the grid is treated like the outer walls
+		return Tile::wall;
+
+	const GridChunk *chunk = chunks[x / GridChunk::size + (y / GridChunk::size) * chunksX].get();
+	return (Tile)chunk->tiles[x % GridChunk::size + (y % GridChunk::size) * GridChunk::size];
+}
+
+bool GridSnapshot::IsWalkable(int x, int y) const {
+	return GetTile(x, y) == Tile::floor;
+}
+
+Cell GridSnapshot::GetStartPos() const {
+	return startPos;
+}
+
+Cell GridSnapshot::GetGoalPos() const {
+	return goalPos;
+}
+
+unsigned long long GridSnapshot::GetVersion() const {
+	return version;
+}
+
+PinnedSnapshot::PinnedSnapshot() {
+}
+
+PinnedSnapshot::PinnedSnapshot(PinnedSnapshot &&other) {
+	owner = other.owner;
+	snapshot = other.snapshot;
+	slot = other.slot;
+	other.owner = nullptr;
+	other.snapshot = nullptr;
+	other.slot = -1;
+}
+
+PinnedSnapshot &PinnedSnapshot::operator=(PinnedSnapshot &&other) {
+	if (this != &other) {
+		Release();
+		owner = other.owner;
+		snapshot = other.snapshot;
+		slot = other.slot;
+		other.owner = nullptr;
+		other.snapshot = nullptr;
+		other.slot = -1;
+	}
+	return *this;
+}
+
+PinnedSnapshot::~PinnedSnapshot() {
+	Release();
+}
+
+const GridSnapshot &PinnedSnapshot::operator*() const {
+	return *snapshot;
+}
+
+const GridSnapshot *PinnedSnapshot::operator->() const {
+	return snapshot;
+}
+
+const GridSnapshot *PinnedSnapshot::Get() const {
+	return snapshot;
+}
+
+void PinnedSnapshot::Release() {
+	if (owner != nullptr)
+		owner->Unpin(slot);
+
+	owner = nullptr;
+	snapshot = nullptr;
+	slot = -1;
+}
+
+VersionedGrid::VersionedGrid(Grid &grid) {
+	GridSnapshot *snapshot = new GridSnapshot();
+	snapshot->width = grid.GetGridX();
+	snapshot->height = grid.GetGridY();
+	snapshot->chunksX = (snapshot->width + GridChunk::size - 1) / GridChunk::size;
+	snapshot->startPos = grid.GetStartPos();
+	snapshot->goalPos = grid.GetGoalPos();
+	snapshot->version = 1;
+
+	int chunksY = (snapshot->height + GridChunk::size - 1) / GridChunk::size;
+	for (int x = 0;x < snapshot->chunksX * chunksY;x++) {
+		std::shared_ptr<GridChunk> chunk = std::make_shared<GridChunk>();
+
+		//Chunks hanging over the edge of the grid are padded with walls
+		for (int y = 0;y < GridChunk::size * GridChunk::size;y++)
+			chunk->tiles[y] = (unsigned char)Tile::wall;
+
+		snapshot->chunks.push_back(chunk);
+	}
+
+	for (int y = 0;y < snapshot->height;y++) {
+		for (int x = 0;x < snapshot->width;x++) {
+			GridChunk *chunk = snapshot->chunks[x / GridChunk::size + (y / GridChunk::size) * snapshot->chunksX].get();
+			chunk->tiles[x % GridChunk::size + (y % GridChunk::size) * GridChunk::size] = (unsigned char)grid.GetCell(x, y).tileType;
+		}
+	}
+
+	current = snapshot;
+}
+
+VersionedGrid::~VersionedGrid() {
+	for (int x = 0;x < retired.size();x++)
+		delete retired[x].snapshot;
+
+	delete current.load();
+}
+
+PinnedSnapshot VersionedGrid::Pin() {
+	//Start looking for a free slot at a per-thread position, so readers rarely collide
+	int start = (int)(std::hash<std::thread::id>()(std::this_thread::get_id()) % maxReaders);
+
+	for (int attempt = 0;;attempt++) {
+		int slot = (start + attempt) % maxReaders;
+
+		//Announce the epoch before reading the snapshot pointer. A writer that retires
+		//the snapshot we are about to read is guaranteed to see this announcement.
+		unsigned long long free = 0;
+		if (readers[slot].epoch.compare_exchange_strong(free, globalEpoch.load())) {
+			PinnedSnapshot pin;
+			pin.owner = this;
+			pin.slot = slot;
+			pin.snapshot = current.load();
+			return pin;
+		}
+
+		if (attempt % maxReaders == maxReaders - 1)
+			std::this_thread::yield(); //Every slot is taken, let a reader finish
+	}
+}
+
+unsigned long long VersionedGrid::GetVersion() {
+	PinnedSnapshot pin = Pin();
+	return pin->GetVersion();
+}
+
+bool VersionedGrid::SetCell(int x, int y, Tile tile) {
+	std::vector<CellEdit> edits;
+	edits.push_back(CellEdit(x, y, tile));
+	return ApplyEdits(edits) == 1;
+}
+
+int VersionedGrid::ApplyEdits(const std::vector<CellEdit> &edits) {
+	std::lock_guard<std::mutex> lock(writerMutex);
+
+	GridSnapshot *snapshot = CopySnapshot();
+	std::vector<bool> copiedChunks = std::vector<bool>(snapshot->chunks.size(), false);
+
+	int applied = 0;
+	for (int x = 0;x < edits.size();x++) {
+		if (edits[x].x < 0 || edits[x].x >= snapshot->width || edits[x].y < 0 || edits[x].y >= snapshot->height)
+			continue;
+
+		*GetWritableTile(snapshot, copiedChunks, edits[x].x, edits[x].y) = (unsigned char)edits[x].tile;
+		applied++;
+	}
+
+	Publish(snapshot);
+	return applied;
+}
+
+void VersionedGrid::PepperWalls() {
+	std::lock_guard<std::mutex> lock(writerMutex);
+
+	GridSnapshot *snapshot = CopySnapshot();
+	std::vector<bool> copiedChunks = std::vector<bool>(snapshot->chunks.size(), false);
+
+	//Same as Grid::PepperWalls: clear to a walled border, then roughly a quarter of the inside becomes walls
+	for (int x = 0;x < snapshot->width;x++) {
+		for (int y = 0;y < snapshot->height;y++) {
+			bool border = x == 0 || x == snapshot->width - 1 || y == 0 || y == snapshot->height - 1;
+			*GetWritableTile(snapshot, copiedChunks, x, y) = (unsigned char)(border ? Tile::wall : Tile::floor);
+		}
+	}
+
+	for (int x = 1;x < snapshot->width - 1;x++) {
+		for (int y = 1;y < snapshot->height - 1;y++) {
+			if ((rand() % 100) < 25)
+				*GetWritableTile(snapshot, copiedChunks, x, y) = (unsigned char)Tile::wall;
+		}
+	}
+
+	Publish(snapshot);
+}
+
+bool VersionedGrid::SetStartPos(int x, int y) {
+	std::lock_guard<std::mutex> lock(writerMutex);
+
+	GridSnapshot *snapshot = CopySnapshot();
+	if (x < 0 || x >= snapshot->width || y < 0 || y >= snapshot->height) {
+		delete snapshot;
+		return false;
+	}
+
+	snapshot->startPos = Cell(x, y);
+	Publish(snapshot);
+	return true;
+}
+
+bool VersionedGrid::SetGoalPos(int x, int y) {
+	std::lock_guard<std::mutex> lock(writerMutex);
+
+	GridSnapshot *snapshot = CopySnapshot();
+	if (x < 0 || x >= snapshot->width || y < 0 || y >= snapshot->height) {
+		delete snapshot;
+		return false;
+	}
+
+	snapshot->goalPos = Cell(x, y);
+	Publish(snapshot);
+	return true;
+}
+
+int VersionedGrid::GetRetiredCount() {
+	std::lock_guard<std::mutex> lock(writerMutex);
+	return (int)retired.size();
+}
+
+GridSnapshot *VersionedGrid::CopySnapshot() {
+	//Only called by writers, so current can't be retired underneath us
+	GridSnapshot *snapshot = new GridSnapshot(*current.load());
+	snapshot->version++;
+	return snapshot;
+}
+
+unsigned char *VersionedGrid::GetWritableTile(GridSnapshot *snapshot, std::vector<bool> &copiedChunks, int x, int y) {
+	int chunkIndex = x / GridChunk::size + (y / GridChunk::size) * snapshot->chunksX;
+
+	//First write to this chunk in this version: give the new version its own copy, older versions keep the original
+	if (!copiedChunks[chunkIndex]) {
+		snapshot->chunks[chunkIndex] = std::make_shared<GridChunk>(*snapshot->chunks[chunkIndex]);
+		copiedChunks[chunkIndex] = true;
+	}
+
+	return &snapshot->chunks[chunkIndex]->tiles[x % GridChunk::size + (y % GridChunk::size) * GridChunk::size];
+}
+
+void VersionedGrid::Publish(GridSnapshot *snapshot) {
+	GridSnapshot *previous = current.exchange(snapshot);
+
+	//Any reader that could have loaded previous announced an epoch no later than this one
+	RetiredSnapshot entry;
+	entry.snapshot = previous;
+	entry.epoch = globalEpoch.fetch_add(1);
+	retired.push_back(entry);
+
+	Reclaim();
+}
+
+void VersionedGrid::Reclaim() {
+	unsigned long long oldestReader = ~0ULL;
+	for (int x = 0;x < maxReaders;x++) {
+		unsigned long long epoch = readers[x].epoch.load();
+		if (epoch != 0 && epoch < oldestReader)
+			oldestReader = epoch;
+	}
+
+	//A snapshot retired in epoch e is only reachable by readers that announced e or earlier
+	int kept = 0;
+	for (int x = 0;x < retired.size();x++) {
+		if (retired[x].epoch < oldestReader)
+			delete retired[x].snapshot;
+		else
+			retired[kept++] = retired[x];
+	}
+	retired.resize(kept);
+}
+
+void VersionedGrid::Unpin(int slot) {
+	readers[slot].epoch.store(0);
+}
+#endif
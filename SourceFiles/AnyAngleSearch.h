@@ -0,0 +1,60 @@
+#ifndef ANYANGLESEARCH_H
+#define ANYANGLESEARCH_H
+
+#include "Cell.h"
+#include "MapSearch.h"
+
+#include <vector>
+
+/*
+One bit per cell, set where the cell can't be walked through, rows padded to whole 64-bit words.
+Satisfies the map interface itself, and answers line-of-sight queries a word at a time along rows.
+*/
+class WallBitmap {
+public:
+	void Reset(int width, int height); /* Resizes to width x height with every cell open */
+
+	template <typename Map>
+	void Build(const Map &map) { /* Copies the walkability of any map type */
+		Reset(map.GetGridX(), map.GetGridY());
+		for (int y = 0;y < height;y++) {
+			for (int x = 0;x < width;x++) {
+				if (!map.IsWalkable(x, y))
+					SetBlocked(x, y, true);
+			}
+		}
+	}
+
+	void SetBlocked(int x, int y, bool blocked); /* Marks a cell blocked or open */
+	bool IsBlocked(int x, int y) const { return x < 0 || x >= width || y < 0 || y >= height || ((bits[y * wordsPerRow + (x >> 6)] >> (x & 63)) & 1); } /* Outside the map counts as blocked */
+
+	int GetGridX() const;
+	int GetGridY() const;
+	bool IsWalkable(int x, int y) const; /* Returns !IsBlocked(x, y) */
+
+	bool HasLineOfSight(int x1, int y1, int x2, int y2) const; /* True if the segment between the two cell centres only touches open cells, and never brushes past a blocked corner */
+	bool IsRowClear(int y, int x1, int x2) const; /* True if every cell of row y from x1 to x2, inclusive, is open */
+private:
+	int width = 0;
+	int height = 0;
+	int wordsPerRow = 0;
+	std::vector<unsigned long long> bits; /* Row-major, row y starts at y * wordsPerRow */
+};
+
+/*
+Lazy Theta* from (startX, startY) to (goalX, goalY): A* over 8-connected cells where a cell's parent may be any
+earlier cell it can see, so paths run at any angle instead of along grid edges.
+Line of sight to the parent is assumed when a cell is generated and only checked when it is expanded,
+which needs far fewer checks than Theta*. Costs are Euclidean, kept in thousandths of a cell so SearchScratch can be reused.
+Diagonal steps never cut a blocked corner, and the goal may always be entered, like Grid's searches.
+Returns the turning points of the path ending at the goal, excluding the start unless start and goal are the same cell.
+*/
+std::vector<Cell> LazyThetaStarSearch(const WallBitmap &walls, int startX, int startY, int goalX, int goalY, SearchScratch &scratch);
+
+/*
+Shortens any path with the same shape as the Grid and map searches return (every cell after start, in order)
+by dropping every cell that the previous kept cell can see past. Returns the kept turning points, excluding start.
+*/
+std::vector<Cell> StringPullPath(const WallBitmap &walls, Cell start, const std::vector<Cell> &path);
+
+#endif
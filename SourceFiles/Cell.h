@@ -9,21 +9,30 @@ enum class Tile : char {
 	goal = 'G'
 };
 
+/* A cell's position and contents, as handed out by Grid. The grid itself stores one byte per cell, see Grid */
 class Cell {
 public:
 	Cell(); /* Initialize the cell with coordinates (0, 0) */
 	Cell(int x, int y); /* Initialize a cell with coordinates (x, y) */
 	int GetF(); /* Returns g + h */
 
-	Cell *parentCell = nullptr; /* The previous cell used in the searching algorithm */
-
 	int x; /* X Coordinate of the cell */
 	int y; /* Y Coordinate of the cell */
-	int g; /* The cumulative cost to move based on title */
-	int h; /* The estimated cost to the goal */
+	int g = 0; /* The cumulative cost to move based on title, filled in on the cells of a search's path */
+	int h = 0; /* The estimated cost to the goal, filled in on the cells of a search's path */
 	Tile tileType = Tile::floor; /* Tile type of this cell */
 	bool startCell = false; /* Flag for if this cell is a start cell or not */
 	bool goalCell = false; /* Flag for if this cell is a goal clel or not */
-	bool visited = false; /* Flag for if this cell has been visited */
+};
+
+/* A single pending change to a cell's tile, used by the batched editing APIs */
+class CellEdit {
+public:
+	CellEdit(); /* An edit setting (0, 0) to a floor tile */
+	CellEdit(int x, int y, Tile tile); /* An edit setting (x, y) to tile */
+
+	int x; /* X Coordinate of the cell to change */
+	int y; /* Y Coordinate of the cell to change */
+	Tile tile; /* The tile to change it to */
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef CLEARANCEMAP_H
+#define CLEARANCEMAP_H
+
+#include "Grid.h"
+#include "GridChange.h"
+
+#include <vector>
+
+class ClearanceMap;
+
+/*
+A ClearanceMap seen by an agent of a given radius: a cell is walkable when the agent's
+(2 * radius + 1) square, centred on the cell, holds only floor tiles.
+Satisfies the map interface, so MapAStarSearch, MapIsochroneSearch and MapNearestGoalsSearch
+all plan for large agents without a separate grid per size.
+*/
+class AgentClearanceView {
+public:
+	AgentClearanceView(const ClearanceMap &clearance, int radius);
+
+	int GetGridX() const;
+	int GetGridY() const;
+	bool IsWalkable(int x, int y) const; /* Returns true if an agent of this radius fits at (x, y) */
+private:
+	const ClearanceMap &clearance;
+	int radius;
+};
+
+/*
+For every cell, the Chebyshev distance to the nearest tile that isn't floor, with the outside of the grid counting as wall.
+Walls are 0, floor next to a wall is 1, and an agent of radius r fits wherever the clearance is more than r.
+Values are capped at maxClearance, which also bounds how far an edit can reach.
+
+The map listens to its Grid's change events and stays current on every SetCell, bulk edit and resize.
+An edit only recomputes a window around the changed rectangle, grown by maxClearance + 1,
+with the same two-pass distance transform a full rebuild uses.
+Like Grid it is single-threaded, don't attach one to a grid edited through a RegionLockedGrid.
+*/
+class ClearanceMap {
+public:
+	static const int defaultMaxClearance = 16;
+
+	ClearanceMap(Grid &grid); /* Builds the map and subscribes to grid's changes. The grid must outlive this object */
+	ClearanceMap(Grid &grid, int maxClearance); /* As above, capping clearance at maxClearance (at most 254) */
+	~ClearanceMap(); /* Unsubscribes from the grid */
+
+	int GetClearance(int x, int y) const; /* Returns the clearance at (x, y), 0 if out of bounds */
+	bool CanFit(int x, int y, int radius) const; /* Returns true if an agent of radius fits with its centre at (x, y) */
+	AgentClearanceView ForAgent(int radius) const; /* Returns a searchable view for agents of radius */
+
+	int GetGridX() const;
+	int GetGridY() const;
+	int GetMaxClearance() const;
+	int GetRecomputedCells() const; /* Returns how many cells the last rebuild or update recomputed */
+
+	void Rebuild(); /* Recomputes the whole map */
+private:
+	ClearanceMap(const ClearanceMap &) = delete;
+	ClearanceMap &operator=(const ClearanceMap &) = delete;
+
+	void OnGridChanged(const GridChange &change);
+	void Recompute(int x1, int y1, int x2, int y2); /* Recomputes the inclusive window, trusting the values around it */
+	int Sample(int x, int y) const; /* Clearance at (x, y), 0 outside the grid */
+
+	Grid &grid;
+	int maxClearance;
+	int width = 0;
+	int height = 0;
+	int listenerId = 0;
+	int recomputedCells = 0;
+	std::vector<unsigned char> clearance; /* Row-major, x + y * width */
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef DISTANCEMATRIX_CPP
+#define DISTANCEMATRIX_CPP
+#include "DistanceMatrix.h"
+
+void DistanceMatrix::Reset(int rows, int columns) {
+	this->rows = rows;
+	this->columns = columns;
+	values.assign(rows * columns, -1);
+}
+
+int DistanceMatrix::GetRows() const {
+	return rows;
+}
+
+int DistanceMatrix::GetColumns() const {
+	return columns;
+}
+
+const std::vector<int> &DistanceMatrix::GetValues() const {
+	return values;
+}
+#endif
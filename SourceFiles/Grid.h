@@ -2,14 +2,41 @@
 #define GRID_H
 
 #include "Cell.h"
+#include "CancellationToken.h"
+#include "GridChange.h"
 
 #include <time.h>
+#include <climits>
+#include <cmath>
+#include <algorithm>
 #include <vector>
 #include <iostream>
+#include <string>
+#include <functional>
 #include <stack>
 #include <queue>
 
-/* A 2d grid filled with Cell */
+/* The search algorithms a Grid can run from its start position to its goal position */
+enum class SearchAlgorithm : char {
+	depthFirst,
+	breadthFirst,
+	greedy,
+	aStar
+};
+
+/* How a Grid lays its cells out in memory. Only changes speed, every method still takes (x, y) and public indices stay x + y * width */
+enum class GridLayout : char {
+	linear, /* Row after row */
+	tiled, /* 8x8 tiles, row after row of them, each tile row after row inside. Vertical neighbors share a 64-byte line */
+	morton /* Z-order (Morton) curve, so nearby cells in any direction are nearby in memory. Pads up to a power of two on each side */
+};
+
+/*
+A 2d grid of cells, stored compactly: one byte per cell holding its tile and flags, and the parents of the last search as
+2-bit directions, four cells to a byte, in a separate array. Positions are implied by where a cell sits, so a million cell
+grid's cells take about 1.25 MB rather than 32 MB as Cell objects. GetCell builds a Cell from those on request.
+Where each cell's byte goes is set by its GridLayout, see SetLayout
+*/
 class Grid {
 public:
 	Grid(); /* Sets up the grid with size (2, 2) boundaries */
@@ -23,6 +50,10 @@ public:
 
 	bool SetCell(int x, int y, Tile tile); /* Attempts to set the value of a cell. Returns true if successful, false if fail */
 	bool SetCell(Cell cell, Tile tile); /* Attempts to set the value of a cell. Returns true if successful, false if fail */
+	int FillRect(int x1, int y1, int x2, int y2, Tile tile); /* Sets every cell of the inclusive rectangle, clipped to the grid. Returns how many cells were in bounds */
+	int ApplyMask(int x, int y, int width, int height, const std::vector<unsigned char> &mask, Tile tile); /* Sets the cells under the non-zero entries of a row-major width x height mask placed at (x, y). Returns how many were in bounds */
+	int ApplyStamp(int x, int y, int width, int height, const std::vector<Tile> &tiles); /* Copies a row-major width x height block of tiles to (x, y). Returns how many were in bounds */
+	int ApplyEdits(const std::vector<CellEdit> &edits); /* Applies every in-bounds edit. Returns how many were applied */
 	Cell GetCell(int x, int y); /* Attempts to get the cell reference */
 	Cell GetCell(Cell cell); /* Attempts to get the cell reference */
 
@@ -31,12 +62,32 @@ public:
 	Cell GetStartPos(); /* Returns the currently marked start cell */
 	void SetStartPos(int x, int y); /* Reallocates the start cell to be (x, y) */
 
-	int GetGridX(); /* Returns the size of the current grid's X value [gridSizeX] */
-	int GetGridY(); /* Returns the size of the current grid's Y value [gridSizeY] */
+	int GetGridX() const; /* Returns the size of the current grid's X value [gridSizeX] */
+	int GetGridY() const; /* Returns the size of the current grid's Y value [gridSizeY] */
+	void SetLayout(GridLayout layout); /* Moves the cells into layout, keeping their contents. Kept through resizes, copies take it along */
+	GridLayout GetLayout() const;
+	size_t GetStorageSize() const; /* Bytes of cell storage, including any padding the layout needs */
+	size_t GetStorageIndex(int x, int y) const; /* Where (x, y)'s byte sits in the cell storage, for measuring locality. (x, y) must be in bounds */
+	bool IsWalkable(int x, int y) const; /* Returns true if (x, y) is inside the grid and a floor tile. Lets MapAStarSearch read the grid without modifying it */
 
 	void OutputGrid(); /* Outputs a generic grid with images to help depict tile types */
+	bool LoadGrid(std::istream &in); /* Loads a grid saved by SaveGrid. Returns false, leaving the grid unspecified, if the input is malformed */
+	void SaveGrid(std::ostream &out); /* Saves the grid as "width height" followed by one row of #, ., S or G per line */
 
-	std::vector<Cell> GetValidNeighbors(int x, int y); /* Get all neighbors that are either floor or goal tiles*/
+	std::vector<Cell> GetValidNeighbors(int x, int y); /* Get all neighbors that are either floor or goal tiles. Allocates, loops should use one of the two below */
+	int GetValidNeighbors(int x, int y, int neighbors[4]) const; /* Writes the indices (x + y * GetGridX()) of the same neighbors into neighbors. Returns how many, never allocates */
+
+	template <typename Visit>
+	void ForEachValidNeighbor(int x, int y, Visit visit) const { /* Calls visit(neighborX, neighborY) for the same neighbors, left, up, right, down. Inlines, never allocates */
+		if (x - 1 >= 0 && IsEnterable(cells[GetIndex(x - 1, y)]))
+			visit(x - 1, y);
+		if (y - 1 >= 0 && IsEnterable(cells[GetIndex(x, y - 1)]))
+			visit(x, y - 1);
+		if (x + 1 < gridSizeX && IsEnterable(cells[GetIndex(x + 1, y)]))
+			visit(x + 1, y);
+		if (y + 1 < gridSizeY && IsEnterable(cells[GetIndex(x, y + 1)]))
+			visit(x, y + 1);
+	}
 	double GetManhattanDistance(int x1, int y1, int x2, int y2); /* Returns the manhattan distance between two points */
 	double GetEuclidianDistance(int x1, int y1, int x2, int y2); /* Returns the euclidian distance between two points */
 
@@ -44,20 +95,107 @@ public:
 	std::vector<Cell> BreadthFirstSearch(); /* Uses BFS to search the grid from start point to goal point */
 	std::vector<Cell> GreedySearch(); /* Uses a Greedy search to find the goal point */
 	std::vector<Cell> AStarSearch(); /* Uses a Greedy search to find the goal point */
+	std::vector<Cell> Search(SearchAlgorithm algorithm); /* Runs the chosen search algorithm from start point to goal point */
+	bool Search(SearchAlgorithm algorithm, std::vector<unsigned int> &path); /* As above, writing the path as indices (x + y * GetGridX()) over path, reusing its memory. Returns false, leaving path alone, if there is none */
 
-	void ResetCellSearchSettings(); /* Resets the visited and parentCell variables for cells */
+	void ResetCellSearchSettings(); /* Clears the visited flag of every cell. Parents are left alone, a search only follows ones it wrote */
 
 	void PepperWalls(); /* Pepper random walls in the grid for testing purposes */
 
 	void SetDisplayAllTraversedCells(bool flag); /* Sets the display all traversed cells flag */
 	bool GetDisplayAllTraversedCells(); /* Retrieves the display all traversed cells flag */
+
+	void SetOutputSearchDiagnostics(bool flag); /* Sets whether searches print their diagnostics (visited cell totals) to the console */
+	bool GetOutputSearchDiagnostics(); /* Retrieves the output search diagnostics flag */
+
+	void SetCancellationToken(const CancellationToken *token); /* Searches stop early once token says so. The grid does not own the token, nullptr disables */
+	bool WasLastSearchCancelled(); /* Returns true if the last search was stopped by its cancellation token */
+
+	unsigned long long GetVersion(); /* Returns the grid's version, which increases with every published change */
+	bool IsDirty(int x, int y); /* Returns true if (x, y) changed since the last ClearDirty */
+	int GetDirtyCount(); /* Returns how many cells changed since the last ClearDirty */
+	void ClearDirty(); /* Marks every cell clean */
+	int AddChangeListener(std::function<void(const GridChange &)> listener); /* Calls listener after every change, on the editing thread. Returns an id for RemoveChangeListener */
+	void RemoveChangeListener(int id); /* Stops calling the listener with this id */
+	void BeginEdits(); /* Holds back change events until the matching EndEdits, then publishes them coalesced under one version. Nests */
+	void EndEdits(); /* Ends a BeginEdits batch */
 private:
+	template <typename OpenList, typename Heuristic, typename NeighborModel, typename CostModel>
+	friend class SearchEngine; /* Runs the searches above against the cells directly */
+
+	/* Bounding box of the cells a bulk edit changed */
+	class EditBounds {
+	public:
+		void Add(int x, int y);
+		bool IsEmpty();
+
+		int x1 = INT_MAX;
+		int y1 = INT_MAX;
+		int x2 = -1;
+		int y2 = -1;
+	};
+
+	/* Layout of a cell's byte */
+	static const unsigned char tileBits = 3; /* The tile, as a code from EncodeTile */
+	static const unsigned char startFlag = 4;
+	static const unsigned char goalFlag = 8;
+	static const unsigned char visitedFlag = 16; /* Set on cells a search has expanded, cleared when it finishes */
+
+	static unsigned char EncodeTile(Tile tile); /* 2-bit code of a tile. Values outside Tile's enumerators are stored as walls */
+	static Tile DecodeTile(unsigned char code);
+	static bool IsEnterable(unsigned char cell) { return (cell & tileBits) == 0 || (cell & goalFlag) != 0; } /* Searches may step onto floor tiles (code 0) and the goal */
+
+	/* Parent directions: 0 left, 1 up, 2 right, 3 down, the same order ForEachValidNeighbor visits in */
+	static int GetDirection(int dx, int dy) { return (dx != 0) ? 1 + dx : 2 + dy; } /* Code of a single 4-way move */
+	static int GetDirectionX(int direction) { return (direction & 1) ? 0 : direction - 1; }
+	static int GetDirectionY(int direction) { return (direction & 1) ? direction - 2 : 0; }
+	int GetParentDirection(int index) const { return (parents[index >> 2] >> ((index & 3) * 2)) & 3; }
+	void SetParentDirection(int index, int direction) {
+		unsigned char &packed = parents[index >> 2];
+		int shift = (index & 3) * 2;
+		packed = (unsigned char)((packed & ~(3 << shift)) | (direction << shift));
+	}
+
+	static int SpreadBits(int value) { /* Moves bit i of a 16-bit value to bit 2i */
+		value = (value | (value << 8)) & 0x00FF00FF;
+		value = (value | (value << 4)) & 0x0F0F0F0F;
+		value = (value | (value << 2)) & 0x33333333;
+		return (value | (value << 1)) & 0x55555555;
+	}
+
+	int GetIndex(int x, int y) const { /* Where (x, y) is stored in cells and parents under the current layout */
+		switch (layout) {
+		case GridLayout::tiled:
+			return ((((y >> 3) * tilesX) + (x >> 3)) << 6) | ((y & 7) << 3) | (x & 7);
+		case GridLayout::morton:
+			//Interleave the bits both axes have, then the longer axis' extra bits go on top, so a rectangle pads to at most 4 times its area
+			return SpreadBits(x & mortonMask) | (SpreadBits(y & mortonMask) << 1) | (((x | y) >> mortonBits) << (2 * mortonBits));
+		default:
+			return x + y * gridSizeX;
+		}
+	}
+	void AllocateStorage(); /* Works out the current layout's constants and sizes cells (all walls) and parents for it */
+	Cell ReadCell(int x, int y) const; /* Builds the Cell for an in-bounds position */
+	void MarkDirty(int x, int y); /* Flags (x, y) in the dirty map */
+	void WriteTile(int x, int y, Tile tile, EditBounds &bounds); /* Sets an in-bounds tile, marking it dirty and growing bounds if it changed */
+	void PublishEdits(EditBounds &bounds); /* Publishes one tiles change covering bounds, if anything changed */
+
 	int gridSizeX = 2; /* Size of the grid in the X direction */
 	int gridSizeY = 2; /* Size of the grid in the Y direction */
-	std::vector<std::vector<Cell>> grid = std::vector<std::vector<Cell>>(); /* A 2d grid filled with Cell */
+	std::vector<unsigned char> cells; /* One byte per cell, laid out as above, at GetIndex(x, y) */
+	std::vector<unsigned char> parents; /* Direction from each cell back to the cell that last pushed it, 2 bits each */
+	GridLayout layout = GridLayout::linear;
+	int tilesX = 0; /* Tiles per row, for GridLayout::tiled */
+	int mortonBits = 0; /* How many low bits of each axis are interleaved, for GridLayout::morton */
+	int mortonMask = 0; /* (1 << mortonBits) - 1 */
 	Cell startPos; /* The currently marked start cell */
 	Cell goalPos;/* The currently marked goal cell */
 	bool displayAllTraversedCells = false;
+	bool outputSearchDiagnostics = true; /* Disabled for grids searched off the console thread, e.g. by the QueryScheduler */
+	const CancellationToken *cancellationToken = nullptr; /* Checked once per expanded cell by every search */
+	bool lastSearchCancelled = false; /* True if the last search returned because of cancellationToken */
+	std::vector<unsigned char> dirtyTiles; /* One flag per cell, x + y * gridSizeX, set when the cell changes. Bytes rather than bits so writers in different regions of a RegionLockedGrid never share a word */
+	GridChangeFeed changes; /* Change events for listeners. Copies of the grid start without listeners */
 };
 
 #endif
\ No newline at end of file
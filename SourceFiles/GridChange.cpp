@@ -0,0 +1,182 @@
+#ifndef GRIDCHANGE_CPP
+#define GRIDCHANGE_CPP
+#include "GridChange.h"
+
+#include <algorithm>
+
+GridChange::GridChange() {
+	this->type = GridChangeType::tiles;
+	this->x1 = 0;
+	this->y1 = 0;
+	this->x2 = 0;
+	this->y2 = 0;
+}
+
+GridChange::GridChange(GridChangeType type, int x1, int y1, int x2, int y2) {
+	this->type = type;
+	this->x1 = std::min(x1, x2);
+	this->y1 = std::min(y1, y2);
+	this->x2 = std::max(x1, x2);
+	this->y2 = std::max(y1, y2);
+}
+
+GridChangeFeed::GridChangeFeed() {
+}
+
+GridChangeFeed::GridChangeFeed(const GridChangeFeed &other) {
+	version = other.GetVersion();
+}
+
+GridChangeFeed &GridChangeFeed::operator=(const GridChangeFeed &other) {
+	version = other.GetVersion();
+	return *this;
+}
+
+int GridChangeFeed::AddListener(std::function<void(const GridChange &)> listener) {
+	std::lock_guard<std::mutex> lock(feedMutex);
+
+	Listener entry;
+	entry.id = nextListenerId++;
+	entry.callback = listener;
+
+	//Copy on write, a publish in progress keeps the list it started with
+	std::shared_ptr<std::vector<Listener>> updated = (listeners != nullptr) ? std::make_shared<std::vector<Listener>>(*listeners) : std::make_shared<std::vector<Listener>>();
+	updated->push_back(entry);
+	listeners = updated;
+	hasListeners = true;
+	return entry.id;
+}
+
+void GridChangeFeed::RemoveListener(int id) {
+	std::lock_guard<std::mutex> lock(feedMutex);
+
+	if (listeners == nullptr)
+		return;
+
+	for (int x = 0;x < listeners->size();x++) {
+		if ((*listeners)[x].id == id) {
+			std::shared_ptr<std::vector<Listener>> updated = std::make_shared<std::vector<Listener>>(*listeners);
+			updated->erase(updated->begin() + x);
+			if (updated->empty())
+				listeners = nullptr;
+			else
+				listeners = updated;
+			hasListeners = listeners != nullptr;
+			return;
+		}
+	}
+}
+
+void GridChangeFeed::BeginBatch() {
+	std::lock_guard<std::mutex> lock(feedMutex);
+	batchDepth++;
+}
+
+void GridChangeFeed::EndBatch() {
+	std::unique_lock<std::mutex> lock(feedMutex);
+	if (batchDepth == 0)
+		return;
+
+	batchDepth--;
+	if (batchDepth > 0 || pending.empty())
+		return;
+
+	//A resize makes every other change in the batch redundant
+	for (int x = 0;x < pending.size();x++) {
+		if (pending[x].type == GridChangeType::resized) {
+			GridChange resize = pending[x];
+			pending.clear();
+			pending.push_back(resize);
+			break;
+		}
+	}
+
+	unsigned long long batchVersion = ++version;
+	std::vector<GridChange> changes;
+	changes.swap(pending);
+	for (int x = 0;x < changes.size();x++)
+		changes[x].version = batchVersion;
+
+	//Listeners run without the lock, so they can edit the grid or unsubscribe themselves
+	std::shared_ptr<const std::vector<Listener>> current = listeners;
+	lock.unlock();
+	if (current == nullptr)
+		return;
+
+	for (int x = 0;x < changes.size();x++)
+		Notify(current, changes[x]);
+}
+
+void GridChangeFeed::Publish(const GridChange &change) {
+	//Nobody to tell and nothing to coalesce into: count the version without touching the lock,
+	//so writers in different regions of a RegionLockedGrid don't queue up behind each other here
+	if (batchDepth.load() == 0 && !hasListeners.load()) {
+		version++;
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(feedMutex);
+	if (batchDepth > 0) {
+		AddPending(change);
+		return;
+	}
+
+	GridChange published = change;
+	published.version = ++version;
+
+	std::shared_ptr<const std::vector<Listener>> current = listeners;
+	lock.unlock();
+	if (current != nullptr)
+		Notify(current, published);
+}
+
+unsigned long long GridChangeFeed::GetVersion() const {
+	return version.load();
+}
+
+void GridChangeFeed::AddPending(const GridChange &change) {
+	int sameType = 0;
+	for (int x = 0;x < pending.size();x++) {
+		if (pending[x].type != change.type)
+			continue;
+
+		sameType++;
+
+		//Merge into a rectangle that overlaps or borders this one
+		GridChange &rect = pending[x];
+		if (change.x1 <= rect.x2 + 1 && change.x2 >= rect.x1 - 1 && change.y1 <= rect.y2 + 1 && change.y2 >= rect.y1 - 1) {
+			rect.x1 = std::min(rect.x1, change.x1);
+			rect.y1 = std::min(rect.y1, change.y1);
+			rect.x2 = std::max(rect.x2, change.x2);
+			rect.y2 = std::max(rect.y2, change.y2);
+			return;
+		}
+	}
+
+	if (sameType < maxPendingRects) {
+		pending.push_back(change);
+		return;
+	}
+
+	//Too scattered to be worth tracking separately, collapse this type into one bounding box
+	GridChange bounds = change;
+	int kept = 0;
+	for (int x = 0;x < pending.size();x++) {
+		if (pending[x].type == change.type) {
+			bounds.x1 = std::min(bounds.x1, pending[x].x1);
+			bounds.y1 = std::min(bounds.y1, pending[x].y1);
+			bounds.x2 = std::max(bounds.x2, pending[x].x2);
+			bounds.y2 = std::max(bounds.y2, pending[x].y2);
+		} else {
+			pending[kept++] = pending[x];
+		}
+	}
+	pending.resize(kept);
+	pending.push_back(bounds);
+}
+
+void GridChangeFeed::Notify(const std::shared_ptr<const std::vector<Listener>> &current, const GridChange &change) {
+	for (int x = 0;x < current->size();x++)
+		(*current)[x].callback(change);
+}
+#endif
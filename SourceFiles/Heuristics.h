@@ -0,0 +1,65 @@
+#ifndef HEURISTICS_H
+#define HEURISTICS_H
+
+#include <cmath>
+
+/*
+Integer distance estimates between two cells, for search heuristics.
+None of these check bounds, callers check their coordinates once before the search loop rather than on every push.
+Everything except EuclideanDistance is constexpr and branch-free, and compiles down to a handful of integer instructions.
+The branch-free forms assume an arithmetic right shift of negative values, which every compiler we build with does.
+*/
+
+/* |value| without a branch */
+constexpr int AbsInt(int value) { return (value ^ (value >> 31)) - (value >> 31); }
+
+/* The smaller of a and b, without a branch */
+constexpr int MinInt(int a, int b) { return b ^ ((a ^ b) & -(a < b)); }
+
+/* The larger of a and b, without a branch */
+constexpr int MaxInt(int a, int b) { return a ^ ((a ^ b) & -(a < b)); }
+
+/* Moves needed with 4-directional unit steps */
+constexpr int ManhattanDistance(int x1, int y1, int x2, int y2) { return AbsInt(x2 - x1) + AbsInt(y2 - y1); }
+
+/* Moves needed with 8-directional unit steps */
+constexpr int ChebyshevDistance(int x1, int y1, int x2, int y2) { return MaxInt(AbsInt(x2 - x1), AbsInt(y2 - y1)); }
+
+/* Cost with 8-directional steps, where a straight step costs straightCost and a diagonal one diagonalCost, e.g. 1000 and 1414 */
+constexpr int OctileDistance(int x1, int y1, int x2, int y2, int straightCost, int diagonalCost) {
+	return straightCost * MaxInt(AbsInt(x2 - x1), AbsInt(y2 - y1)) + (diagonalCost - straightCost) * MinInt(AbsInt(x2 - x1), AbsInt(y2 - y1));
+}
+
+/* Largest integer whose square is at most value, one result bit per iteration. For constant tables, at runtime EuclideanDistance is faster */
+constexpr unsigned int IntegerSqrt(unsigned long long value) {
+	unsigned long long root = 0;
+	unsigned long long bit = 1ULL << 62;
+	while (bit > value)
+		bit >>= 2;
+
+	while (bit != 0) {
+		if (value >= root + bit) {
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else {
+			root >>= 1;
+		}
+
+		bit >>= 2;
+	}
+
+	return (unsigned int)root;
+}
+
+/* Straight line distance times scale, rounded down. Exact, so scale 1000 gives thousandths of a cell */
+constexpr int ScaledEuclideanDistance(int x1, int y1, int x2, int y2, int scale) {
+	return (int)IntegerSqrt((unsigned long long)scale * scale * ((long long)(x2 - x1) * (x2 - x1) + (long long)(y2 - y1) * (y2 - y1)));
+}
+
+/* Straight line distance rounded down, as Cell::h stores it. One hardware square root, no pow */
+inline int EuclideanDistance(int x1, int y1, int x2, int y2) {
+	return (int)sqrt((double)((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1)));
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef ISOCHRONE_CPP
+#define ISOCHRONE_CPP
+#include "Isochrone.h"
+
+#include <algorithm>
+
+void ReachableRegion::Begin(int width, int height, int maxCost) {
+	this->width = width;
+	this->height = height;
+	this->maxCost = maxCost;
+
+	int cellCount = width * height;
+	int wordCount = (cellCount + 63) / 64;
+
+	//Distances are only read where the bitmap says so, so they never need clearing
+	if ((int)distances.size() < cellCount)
+		distances.resize(cellCount);
+
+	//Exactly wordCount words, so GetBitmap never hands out a previous, larger map's tail. Shrinking keeps the capacity
+	bitmap.assign(wordCount, 0ULL);
+
+	cells.clear();
+}
+
+bool ReachableRegion::IsReachable(int x, int y) const {
+	if (x < 0 || x >= width || y < 0 || y >= height)
+		return false;
+
+	return IsReachedIndex(x + y * width);
+}
+
+int ReachableRegion::GetDistance(int x, int y) const {
+	if (!IsReachable(x, y))
+		return -1;
+
+	return distances[x + y * width];
+}
+
+int ReachableRegion::GetReachedCount() const {
+	return (int)cells.size();
+}
+
+const std::vector<int> &ReachableRegion::GetReachedCells() const {
+	return cells;
+}
+
+const std::vector<unsigned long long> &ReachableRegion::GetBitmap() const {
+	return bitmap;
+}
+
+int ReachableRegion::GetWidth() const {
+	return width;
+}
+
+int ReachableRegion::GetHeight() const {
+	return height;
+}
+
+int ReachableRegion::GetMaxCost() const {
+	return maxCost;
+}
+#endif
@@ -0,0 +1,118 @@
+#ifndef ISOCHRONE_H
+#define ISOCHRONE_H
+
+#include "Cell.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/*
+The cells reachable from a source within a move budget, with how many moves each one takes.
+Pass the same ReachableRegion to every query: its arrays keep their capacity, and a query only clears the bitmap,
+so repeated queries cost little more than the cells they actually reach.
+*/
+class ReachableRegion {
+public:
+	void Begin(int width, int height, int maxCost); /* Prepares for a new query over a width x height map */
+
+	bool IsReachable(int x, int y) const; /* Returns true if (x, y) can be reached within the budget */
+	int GetDistance(int x, int y) const; /* Returns the moves needed to reach (x, y), or -1 if it can't be reached within the budget */
+	int GetReachedCount() const; /* Returns how many cells were reached, including the source */
+	const std::vector<int> &GetReachedCells() const; /* Returns the reached cell indices (x + y * width), in order of distance */
+	const std::vector<unsigned long long> &GetBitmap() const; /* Returns the reachable bitmap, bit (x + y * width) set when reachable. Holds (width * height + 63) / 64 words */
+
+	int GetWidth() const;
+	int GetHeight() const;
+	int GetMaxCost() const; /* Returns the move budget of the last query */
+
+	void Reach(int index, int distance) { bitmap[index >> 6] |= 1ULL << (index & 63); distances[index] = distance; cells.push_back(index); } /* Records a newly reached cell */
+	bool IsReachedIndex(int index) const { return (bitmap[index >> 6] >> (index & 63)) & 1; } /* IsReachable by cell index */
+	int GetDistanceIndex(int index) const { return distances[index]; } /* GetDistance by cell index, only valid when IsReachedIndex */
+private:
+	int width = 0;
+	int height = 0;
+	int maxCost = 0;
+	std::vector<unsigned long long> bitmap; /* One bit per cell */
+	std::vector<int> distances; /* Only meaningful where the bitmap is set */
+	std::vector<int> cells; /* Reached cells in BFS order, which doubles as the BFS queue */
+};
+
+/*
+Finds every cell reachable from (sourceX, sourceY) in at most maxCost 4-directional moves over floor tiles.
+Works on any map providing int GetGridX() const, int GetGridY() const and bool IsWalkable(int x, int y) const.
+Every move costs 1, so a breadth-first search gives exact distances and expansion stops at the budget.
+The source is always reachable at distance 0 when it is inside the map. Returns the number of cells reached.
+*/
+template <typename Map>
+int MapIsochroneSearch(const Map &map, int sourceX, int sourceY, int maxCost, ReachableRegion &region) {
+	int width = map.GetGridX();
+	int height = map.GetGridY();
+	region.Begin(width, height, maxCost);
+
+	if (sourceX < 0 || sourceX >= width || sourceY < 0 || sourceY >= height || maxCost < 0)
+		return 0;
+
+	const int offsetX[4] = { -1, 0, 1, 0 };
+	const int offsetY[4] = { 0, -1, 0, 1 };
+
+	region.Reach(sourceX + sourceY * width, 0);
+
+	//The reached list is appended to in distance order, so walking it is the BFS queue
+	for (int head = 0;head < region.GetReachedCount();head++) {
+		int current = region.GetReachedCells()[head];
+		int distance = region.GetDistanceIndex(current);
+		if (distance >= maxCost)
+			break; //Everything after this is at least as far, nothing left can grow the region
+
+		int currentX = current % width;
+		int currentY = current / width;
+
+		for (int direction = 0;direction < 4;direction++) {
+			int x = currentX + offsetX[direction];
+			int y = currentY + offsetY[direction];
+			if (x < 0 || x >= width || y < 0 || y >= height)
+				continue;
+
+			int index = x + y * width;
+			if (region.IsReachedIndex(index) || !map.IsWalkable(x, y))
+				continue;
+
+			region.Reach(index, distance + 1);
+		}
+	}
+
+	return region.GetReachedCount();
+}
+
+/*
+Runs MapIsochroneSearch for every source, spread over threadCount threads (0 uses the hardware thread count).
+regions is resized to match sources and region x answers source x. Reusing the same vector across calls reuses its memory.
+The map is only read, so it may be shared by all threads as long as nobody edits it meanwhile.
+*/
+template <typename Map>
+void MapIsochroneSearchMany(const Map &map, const std::vector<Cell> &sources, int maxCost, std::vector<ReachableRegion> &regions, int threadCount) {
+	regions.resize(sources.size());
+
+	if (threadCount <= 0)
+		threadCount = (int)std::thread::hardware_concurrency();
+	if (threadCount > (int)sources.size())
+		threadCount = (int)sources.size();
+
+	//Threads pull the next source off a shared counter, so one slow source doesn't hold up a whole share
+	std::atomic<int> nextSource{ 0 };
+	auto work = [&]() {
+		for (int x = nextSource++;x < (int)sources.size();x = nextSource++)
+			MapIsochroneSearch(map, sources[x].x, sources[x].y, maxCost, regions[x]);
+	};
+
+	std::vector<std::thread> threads;
+	for (int x = 1;x < threadCount;x++)
+		threads.push_back(std::thread(work));
+
+	work(); //The calling thread takes a share too
+	for (int x = 0;x < threads.size();x++)
+		threads[x].join();
+}
+
+#endif
@@ -0,0 +1,352 @@
+#ifndef KSHORTESTPATHS_H
+#define KSHORTESTPATHS_H
+
+#include "Cell.h"
+#include "Isochrone.h"
+#include "MapSearch.h"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+/* One of several routes between the same start and goal */
+class AlternativeRoute {
+public:
+	std::vector<Cell> path; /* Excludes the start cell, unless start and goal are the same cell */
+	int cost = 0; /* Moves along path */
+};
+
+/* Returns how much of candidate is new compared to other, from 0 (every cell shared) to 1 (nothing shared). Paths are cell indices */
+double GetPathDissimilarity(const std::vector<int> &candidate, const std::vector<int> &other);
+
+/*
+Backward BFS from goalIndex: every cell's distance to the goal, for routes that leave startIndex and never come back to it.
+Shared by every search of one k-shortest or alternative-route query as its heuristic. Returns false if the start can't reach the goal.
+*/
+template <typename Map>
+bool MapGoalDistances(const Map &map, int startIndex, int goalIndex, ReachableRegion &toGoal) {
+	int width = map.GetGridX();
+	int height = map.GetGridY();
+
+	const int offsetX[4] = { -1, 0, 1, 0 };
+	const int offsetY[4] = { 0, -1, 0, 1 };
+
+	//A cell joins once a step from it onto an already reached cell is allowed
+	toGoal.Begin(width, height, -1);
+	toGoal.Reach(goalIndex, 0);
+	for (int head = 0;head < toGoal.GetReachedCount();head++) {
+		int current = toGoal.GetReachedCells()[head];
+		if (current == startIndex)
+			continue; //Nothing needs to pass through the start
+
+		for (int direction = 0;direction < 4;direction++) {
+			int x = current % width + offsetX[direction];
+			int y = current / width + offsetY[direction];
+			if (x < 0 || x >= width || y < 0 || y >= height)
+				continue;
+
+			int index = x + y * width;
+			if (!toGoal.IsReachedIndex(index) && (index == startIndex || map.IsWalkable(x, y)))
+				toGoal.Reach(index, toGoal.GetDistanceIndex(current) + 1);
+		}
+	}
+
+	return toGoal.IsReachedIndex(startIndex);
+}
+
+/*
+A* from spurIndex to goalIndex for Yen's algorithm, skipping cells flagged in blocked and the steps from spurIndex to blockedNext.
+toGoal holds every cell's distance to the goal on the unmodified map, an exact heuristic there and an admissible one once
+cells and steps are taken away, so spur searches go almost straight to the goal.
+Writes the cells from spurIndex to goalIndex, both included, into path. Returns false if there is no path.
+*/
+template <typename Map>
+bool MapSpurSearch(const Map &map, int spurIndex, int goalIndex, int startIndex, const ReachableRegion &toGoal, const std::vector<char> &blocked, const std::vector<int> &blockedNext, SearchScratch &scratch, std::vector<int> &path) {
+	int width = map.GetGridX();
+	int height = map.GetGridY();
+	path.clear();
+
+	scratch.Begin(width * height);
+	scratch.See(spurIndex, 0, -1);
+	scratch.open.push_back(((long long)toGoal.GetDistanceIndex(spurIndex) << 32) | spurIndex);
+
+	const int offsetX[4] = { -1, 0, 1, 0 };
+	const int offsetY[4] = { 0, -1, 0, 1 };
+
+	while (!scratch.open.empty()) {
+		std::pop_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		int current = (int)(scratch.open.back() & 0xFFFFFFFF);
+		scratch.open.pop_back();
+
+		if (scratch.IsClosed(current))
+			continue;
+
+		scratch.Close(current);
+		scratch.expandedCells++;
+
+		if (current == goalIndex) {
+			for (int index = goalIndex;index != -1;index = scratch.parent[index])
+				path.push_back(index);
+
+			std::reverse(path.begin(), path.end());
+			return true;
+		}
+
+		int currentX = current % width;
+		int currentY = current / width;
+		if (current != startIndex && !map.IsWalkable(currentX, currentY))
+			continue;
+
+		for (int direction = 0;direction < 4;direction++) {
+			int x = currentX + offsetX[direction];
+			int y = currentY + offsetY[direction];
+			if (x < 0 || x >= width || y < 0 || y >= height)
+				continue;
+
+			int index = x + y * width;
+			if (scratch.IsClosed(index) || blocked[index] || !toGoal.IsReachedIndex(index))
+				continue; //Cells that couldn't reach the goal before anything was taken away can't now
+			if (current == spurIndex && std::find(blockedNext.begin(), blockedNext.end(), index) != blockedNext.end())
+				continue;
+
+			int cost = scratch.g[current] + 1;
+			if (scratch.IsSeen(index) && scratch.g[index] <= cost)
+				continue;
+
+			scratch.See(index, cost, current);
+			long long f = cost + toGoal.GetDistanceIndex(index);
+			scratch.open.push_back((f << 32) | index);
+			std::push_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		}
+	}
+
+	return false;
+}
+
+/*
+Up to k loopless routes from (startX, startY) to (goalX, goalY) in order of length, using Yen's algorithm.
+Works on any map providing int GetGridX() const, int GetGridY() const and bool IsWalkable(int x, int y) const.
+
+One backward BFS from the goal is shared by every spur search as its heuristic, instead of each one searching from scratch.
+Grids have huge numbers of equally short routes that differ by one cell, so a route is only returned when
+GetPathDissimilarity against every route already returned is at least minDissimilarity (0 returns plain Yen's routes).
+Rejected routes still seed later deviations. At most maxRounds routes are examined before giving up on finding k.
+Yen's routes are exact but, with a high threshold, can take many rounds; MapPenaltyAlternativeRoutes finds distinct routes much faster.
+*/
+template <typename Map>
+std::vector<AlternativeRoute> MapKShortestPaths(const Map &map, int startX, int startY, int goalX, int goalY, int k, double minDissimilarity, int maxRounds, SearchScratch &scratch) {
+	std::vector<AlternativeRoute> routes;
+	int width = map.GetGridX();
+	int height = map.GetGridY();
+
+	if (startX < 0 || startX >= width || startY < 0 || startY >= height || goalX < 0 || goalX >= width || goalY < 0 || goalY >= height || k <= 0)
+		return routes;
+
+	int startIndex = startX + startY * width;
+	int goalIndex = goalX + goalY * width;
+
+	ReachableRegion toGoal;
+	if (!MapGoalDistances(map, startIndex, goalIndex, toGoal))
+		return routes;
+
+	std::vector<char> blocked = std::vector<char>(width * height, 0);
+	std::vector<int> blockedNext;
+	std::vector<int> spurPath;
+
+	std::vector<std::vector<int>> accepted; //Yen's A: every route taken off the candidate list, returned or not
+	std::vector<std::vector<int>> returned;
+	std::vector<std::vector<int>> candidates; //Yen's B
+
+	MapSpurSearch(map, startIndex, goalIndex, startIndex, toGoal, blocked, blockedNext, scratch, spurPath);
+	accepted.push_back(spurPath);
+
+	for (int round = 0;round < maxRounds;round++) {
+		const std::vector<int> &route = accepted.back();
+
+		//Keep the route if it differs enough from everything returned so far
+		bool distinct = true;
+		for (int x = 0;x < returned.size() && distinct;x++)
+			distinct = GetPathDissimilarity(route, returned[x]) >= minDissimilarity;
+
+		if (distinct) {
+			returned.push_back(route);
+
+			AlternativeRoute result;
+			result.cost = (int)route.size() - 1;
+			for (int x = (route.size() > 1) ? 1 : 0;x < route.size();x++)
+				result.path.push_back(Cell(route[x] % width, route[x] / width));
+			routes.push_back(result);
+
+			if ((int)routes.size() == k)
+				break;
+		}
+
+		//Deviate from every cell of the latest route except the goal
+		for (int i = 0;i + 1 < (int)route.size();i++) {
+			int spur = route[i];
+
+			//Steps out of the spur already taken by routes sharing this root are off limits
+			blockedNext.clear();
+			for (int x = 0;x < accepted.size();x++) {
+				if ((int)accepted[x].size() > i + 1 && std::equal(route.begin(), route.begin() + i + 1, accepted[x].begin()))
+					blockedNext.push_back(accepted[x][i + 1]);
+			}
+
+			//So is the root itself, to keep routes loopless
+			for (int x = 0;x < i;x++)
+				blocked[route[x]] = 1;
+
+			bool found = MapSpurSearch(map, spur, goalIndex, startIndex, toGoal, blocked, blockedNext, scratch, spurPath);
+
+			for (int x = 0;x < i;x++)
+				blocked[route[x]] = 0;
+
+			if (!found)
+				continue;
+
+			std::vector<int> candidate = std::vector<int>(route.begin(), route.begin() + i);
+			candidate.insert(candidate.end(), spurPath.begin(), spurPath.end());
+			if (std::find(candidates.begin(), candidates.end(), candidate) == candidates.end())
+				candidates.push_back(candidate);
+		}
+
+		if (candidates.empty())
+			break;
+
+		//The shortest candidate becomes the next route, the first found wins ties
+		int best = 0;
+		for (int x = 1;x < candidates.size();x++) {
+			if (candidates[x].size() < candidates[best].size())
+				best = x;
+		}
+
+		accepted.push_back(candidates[best]);
+		candidates.erase(candidates.begin() + best);
+	}
+
+	return routes;
+}
+
+/*
+A* from startIndex to goalIndex where entering a cell costs 100 plus penalties[cell], so routes drift away from penalized cells.
+Penalties only add cost, so 100 times the unpenalized goal distance stays an admissible heuristic.
+Writes the route, both ends included, into path. Returns false if there is no path.
+*/
+template <typename Map>
+bool MapPenaltySearch(const Map &map, int startIndex, int goalIndex, const ReachableRegion &toGoal, const std::vector<int> &penalties, SearchScratch &scratch, std::vector<int> &path) {
+	int width = map.GetGridX();
+	int height = map.GetGridY();
+	path.clear();
+
+	scratch.Begin(width * height);
+	scratch.See(startIndex, 0, -1);
+	scratch.open.push_back(((long long)toGoal.GetDistanceIndex(startIndex) * 100 << 32) | startIndex);
+
+	const int offsetX[4] = { -1, 0, 1, 0 };
+	const int offsetY[4] = { 0, -1, 0, 1 };
+
+	while (!scratch.open.empty()) {
+		std::pop_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		int current = (int)(scratch.open.back() & 0xFFFFFFFF);
+		scratch.open.pop_back();
+
+		if (scratch.IsClosed(current))
+			continue;
+
+		scratch.Close(current);
+		scratch.expandedCells++;
+
+		if (current == goalIndex) {
+			for (int index = goalIndex;index != -1;index = scratch.parent[index])
+				path.push_back(index);
+
+			std::reverse(path.begin(), path.end());
+			return true;
+		}
+
+		int currentX = current % width;
+		int currentY = current / width;
+		if (current != startIndex && !map.IsWalkable(currentX, currentY))
+			continue;
+
+		for (int direction = 0;direction < 4;direction++) {
+			int x = currentX + offsetX[direction];
+			int y = currentY + offsetY[direction];
+			if (x < 0 || x >= width || y < 0 || y >= height)
+				continue;
+
+			int index = x + y * width;
+			if (scratch.IsClosed(index) || index == startIndex || !toGoal.IsReachedIndex(index))
+				continue;
+
+			int cost = scratch.g[current] + 100 + penalties[index];
+			if (scratch.IsSeen(index) && scratch.g[index] <= cost)
+				continue;
+
+			scratch.See(index, cost, current);
+			long long f = cost + (long long)toGoal.GetDistanceIndex(index) * 100;
+			scratch.open.push_back((f << 32) | index);
+			std::push_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		}
+	}
+
+	return false;
+}
+
+/*
+Up to k alternative routes from (startX, startY) to (goalX, goalY) with the penalty method: after each search,
+every cell of the route found gets penaltyPercent percent more expensive to enter, and the search runs again.
+A route is returned when GetPathDissimilarity against every route already returned is at least minDissimilarity.
+The first route is a shortest one, later ones are good rather than optimal. Gives up after maxRounds searches.
+All searches share one backward BFS from the goal as their heuristic.
+*/
+template <typename Map>
+std::vector<AlternativeRoute> MapPenaltyAlternativeRoutes(const Map &map, int startX, int startY, int goalX, int goalY, int k, double minDissimilarity, int penaltyPercent, int maxRounds, SearchScratch &scratch) {
+	std::vector<AlternativeRoute> routes;
+	int width = map.GetGridX();
+	int height = map.GetGridY();
+
+	if (startX < 0 || startX >= width || startY < 0 || startY >= height || goalX < 0 || goalX >= width || goalY < 0 || goalY >= height || k <= 0)
+		return routes;
+
+	int startIndex = startX + startY * width;
+	int goalIndex = goalX + goalY * width;
+
+	ReachableRegion toGoal;
+	if (!MapGoalDistances(map, startIndex, goalIndex, toGoal))
+		return routes;
+
+	std::vector<int> penalties = std::vector<int>(width * height, 0);
+	std::vector<std::vector<int>> returned;
+	std::vector<int> route;
+
+	for (int round = 0;round < maxRounds && (int)routes.size() < k;round++) {
+		if (!MapPenaltySearch(map, startIndex, goalIndex, toGoal, penalties, scratch, route))
+			break;
+
+		bool distinct = true;
+		for (int x = 0;x < returned.size() && distinct;x++)
+			distinct = GetPathDissimilarity(route, returned[x]) >= minDissimilarity;
+
+		if (distinct) {
+			returned.push_back(route);
+
+			AlternativeRoute result;
+			result.cost = (int)route.size() - 1;
+			for (int x = (route.size() > 1) ? 1 : 0;x < route.size();x++)
+				result.path.push_back(Cell(route[x] % width, route[x] / width));
+			routes.push_back(result);
+		}
+
+		//Push the next search away from this route, the start and goal are shared by every route anyway
+		for (int x = 1;x + 1 < (int)route.size();x++)
+			penalties[route[x]] += penaltyPercent;
+
+		if (route.size() <= 2)
+			break; //Start and goal are neighbours or the same cell, there is nothing to route around
+	}
+
+	return routes;
+}
+
+#endif
\ No newline at end of file
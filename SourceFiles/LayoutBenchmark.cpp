@@ -0,0 +1,231 @@
+#ifndef LAYOUTBENCHMARK_CPP
+#define LAYOUTBENCHMARK_CPP
+#include "LayoutBenchmark.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iomanip>
+
+/* The regions SearchEngine touches, far enough apart in the modelled address space to never share a line */
+static const unsigned long long cellsBase = 0;
+static const unsigned long long parentsBase = 1ULL << 40;
+static const unsigned long long costsBase = 2ULL << 40;
+
+CacheModel::CacheModel(size_t bytes, int ways) : ways(ways) {
+	sets = std::max(bytes / (64 * (size_t)ways), (size_t)1);
+	lines.assign(sets * ways, ~0ULL);
+}
+
+void CacheModel::Touch(unsigned long long address) {
+	unsigned long long line = address >> 6;
+	unsigned long long *set = &lines[(size_t)(line % sets) * ways];
+
+	//A hit moves the line to the front, a miss pushes the least recently used one off the end
+	int found = ways - 1;
+	for (int x = 0;x < ways;x++) {
+		if (set[x] == line) {
+			found = x;
+			break;
+		}
+	}
+
+	if (set[found] != line)
+		misses++;
+
+	for (int x = found;x > 0;x--)
+		set[x] = set[x - 1];
+	set[0] = line;
+}
+
+long long CacheModel::GetMisses() const {
+	return misses;
+}
+
+/* Opens a disabled counter of this thread's cache misses. Returns -1 if the platform or the kernel doesn't allow it */
+static int OpenMissCounter() {
+#ifdef __linux__
+	perf_event_attr attributes;
+	memset(&attributes, 0, sizeof(attributes));
+	attributes.type = PERF_TYPE_HARDWARE;
+	attributes.size = sizeof(attributes);
+	attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+	attributes.disabled = 1;
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+	return (int)syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+#else
+	return -1;
+#endif
+}
+
+static void StartMissCounter(int counter) {
+#ifdef __linux__
+	if (counter < 0)
+		return;
+
+	ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+	ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+}
+
+/* Stops and closes the counter. Returns what it counted, or -1 if it never opened */
+static long long StopMissCounter(int counter) {
+#ifdef __linux__
+	if (counter < 0)
+		return -1;
+
+	ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+	long long count = -1;
+	if (read(counter, &count, sizeof(count)) != sizeof(count))
+		count = -1;
+	close(counter);
+	return count;
+#else
+	return -1;
+#endif
+}
+
+/*
+Replays a breadth first search from start to goal the way SearchEngine runs it, showing cache every byte it would touch.
+Cells go on the fringe every time a neighbor reaches them unvisited and count once, on their first pop. Returns how many were expanded
+*/
+static long long ReplaySearch(const Grid &grid, Cell start, Cell goal, CacheModel &cache) {
+	static const int offsetX[4] = { -1, 0, 1, 0 };
+	static const int offsetY[4] = { 0, -1, 0, 1 };
+
+	int width = grid.GetGridX();
+	int height = grid.GetGridY();
+	std::vector<bool> visited = std::vector<bool>((size_t)width * height, false);
+	std::deque<Cell> fringe;
+	fringe.push_back(start);
+
+	long long expanded = 0;
+	while (!fringe.empty()) {
+		Cell current = fringe.front();
+		fringe.pop_front();
+
+		//Visited check, then the visited and goal flags, all in the cell's byte
+		size_t index = grid.GetStorageIndex(current.x, current.y);
+		cache.Touch(cellsBase + index);
+		if (visited[current.x + (size_t)current.y * width])
+			continue;
+
+		visited[current.x + (size_t)current.y * width] = true;
+		expanded++;
+		if (current.x == goal.x && current.y == goal.y)
+			break;
+
+		cache.Touch(costsBase + index * sizeof(int));
+		for (int direction = 0;direction < 4;direction++) {
+			int x = current.x + offsetX[direction];
+			int y = current.y + offsetY[direction];
+			if (x < 0 || x >= width || y < 0 || y >= height)
+				continue;
+
+			size_t neighbor = grid.GetStorageIndex(x, y);
+			cache.Touch(cellsBase + neighbor);
+			if (!(grid.IsWalkable(x, y) || (x == goal.x && y == goal.y)) || visited[x + (size_t)y * width])
+				continue;
+
+			cache.Touch(parentsBase + neighbor / 4);
+			cache.Touch(costsBase + neighbor * sizeof(int));
+			fringe.push_back(Cell(x, y));
+		}
+	}
+
+	//ResetCellSearchSettings sweeps the whole storage
+	for (size_t x = 0;x < grid.GetStorageSize();x += 64)
+		cache.Touch(cellsBase + x);
+
+	return expanded;
+}
+
+std::vector<LayoutBenchmarkResult> BenchmarkGridLayouts(int width, int height, int searches) {
+	Grid map = Grid(width, height);
+	map.SetOutputSearchDiagnostics(false);
+	map.PepperWalls();
+
+	//Every layout runs the same queries, between random floor cells
+	std::vector<Cell> starts;
+	std::vector<Cell> goals;
+	for (int x = 0;x < searches;x++) {
+		Cell ends[2];
+		for (int end = 0;end < 2;end++) {
+			do {
+				ends[end] = Cell(rand() % width, rand() % height);
+			} while (!map.IsWalkable(ends[end].x, ends[end].y));
+		}
+
+		starts.push_back(ends[0]);
+		goals.push_back(ends[1]);
+	}
+
+	const GridLayout layouts[3] = { GridLayout::linear, GridLayout::tiled, GridLayout::morton };
+	std::vector<LayoutBenchmarkResult> results;
+	for (int layout = 0;layout < 3;layout++) {
+		Grid grid = map;
+		grid.SetLayout(layouts[layout]);
+
+		LayoutBenchmarkResult result;
+		result.layout = layouts[layout];
+		result.storageBytes = grid.GetStorageSize();
+		result.searches = searches;
+
+		//One untimed search first, so the search arena has grown to size before timing starts
+		std::vector<unsigned int> path;
+		grid.SetStartPos(starts[0].x, starts[0].y);
+		grid.SetGoalPos(goals[0].x, goals[0].y);
+		grid.Search(SearchAlgorithm::breadthFirst, path);
+
+		int counter = OpenMissCounter();
+		StartMissCounter(counter);
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		for (int x = 0;x < searches;x++) {
+			grid.SetStartPos(starts[x].x, starts[x].y);
+			grid.SetGoalPos(goals[x].x, goals[x].y);
+			grid.Search(SearchAlgorithm::breadthFirst, path);
+		}
+		result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+		result.hardwareMisses = StopMissCounter(counter);
+
+		CacheModel cache = CacheModel(32 * 1024, 8);
+		for (int x = 0;x < searches;x++)
+			result.expandedCells += ReplaySearch(grid, starts[x], goals[x], cache);
+		result.simulatedMisses = cache.GetMisses();
+
+		results.push_back(result);
+	}
+
+	return results;
+}
+
+void PrintLayoutBenchmark(std::ostream &out, const std::vector<LayoutBenchmarkResult> &results) {
+	static const char *names[3] = { "linear", "8x8 tiled", "morton" };
+
+	out << std::left << std::setw(11) << "Layout" << std::right << std::setw(11) << "Storage KB" << std::setw(12) << "Expanded"
+		<< std::setw(12) << "ns/cell" << std::setw(10) << "Speed" << std::setw(16) << "Sim. misses" << std::setw(16) << "CPU misses" << "\n";
+
+	for (int x = 0;x < results.size();x++) {
+		const LayoutBenchmarkResult &result = results[x];
+		double nanoseconds = (result.expandedCells > 0) ? result.milliseconds * 1000000.0 / result.expandedCells : 0;
+		double speed = (result.milliseconds > 0) ? results[0].milliseconds / result.milliseconds : 0;
+
+		out << std::left << std::setw(11) << names[(int)result.layout] << std::right << std::setw(11) << result.storageBytes / 1024
+			<< std::setw(12) << result.expandedCells << std::setw(12) << std::fixed << std::setprecision(1) << nanoseconds
+			<< std::setw(9) << std::setprecision(2) << speed << "x" << std::setw(16) << result.simulatedMisses;
+		if (result.hardwareMisses >= 0)
+			out << std::setw(16) << result.hardwareMisses << "\n";
+		else
+			out << std::setw(16) << "n/a" << "\n";
+	}
+}
+#endif
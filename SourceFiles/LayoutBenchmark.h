@@ -0,0 +1,48 @@
+#ifndef LAYOUTBENCHMARK_H
+#define LAYOUTBENCHMARK_H
+
+#include "Grid.h"
+
+#include <stddef.h>
+#include <ostream>
+#include <vector>
+
+/* A set-associative cache with 64-byte lines and least recently used replacement, counting misses over the addresses it is shown */
+class CacheModel {
+public:
+	CacheModel(size_t bytes, int ways); /* bytes / (64 * ways) sets of ways lines each */
+
+	void Touch(unsigned long long address); /* Reads or writes the byte at address */
+	long long GetMisses() const;
+private:
+	int ways;
+	size_t sets;
+	std::vector<unsigned long long> lines; /* ways per set, most recently used first. ~0 is empty */
+	long long misses = 0;
+};
+
+/* How one GridLayout did in BenchmarkGridLayouts */
+class LayoutBenchmarkResult {
+public:
+	GridLayout layout = GridLayout::linear;
+	size_t storageBytes = 0; /* Cell storage, including the layout's padding */
+	int searches = 0;
+	long long expandedCells = 0; /* Cells expanded over all the searches */
+	double milliseconds = 0; /* Wall time of the searches */
+	long long simulatedMisses = 0; /* Misses of the modelled cache replaying the searches, see BenchmarkGridLayouts */
+	long long hardwareMisses = -1; /* Cache misses the CPU counted during the searches, -1 where they can't be read */
+};
+
+/*
+Runs the same breadth first searches, which spread out evenly in every direction, over copies of one width x height map
+with random walls, once per GridLayout, and reports how each layout did.
+Cache behaviour is measured two ways:
+	- simulated: each search's expansion order replayed against a 32 KB, 8-way, 64-byte-line LRU cache, touching the cell bytes,
+	  packed parents and cost table the way SearchEngine does. Deterministic, so comparable between machines
+	- hardware: cache misses from the CPU's counters through perf_event_open, on Linux only
+Uses rand() for the map and the search endpoints.
+*/
+std::vector<LayoutBenchmarkResult> BenchmarkGridLayouts(int width, int height, int searches);
+void PrintLayoutBenchmark(std::ostream &out, const std::vector<LayoutBenchmarkResult> &results); /* A table with one row per layout, speed relative to the first row */
+
+#endif
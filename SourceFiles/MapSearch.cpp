@@ -0,0 +1,19 @@
+#ifndef MAPSEARCH_CPP
+#define MAPSEARCH_CPP
+#include "MapSearch.h"
+
+void SearchScratch::Begin(int cellCount) {
+	//Only touch every cell when the arrays grow, or once every 4 billion searches when the generation wraps
+	if ((int)seenStamp.size() < cellCount || generation == 0xFFFFFFFF) {
+		g.assign(cellCount, 0);
+		parent.assign(cellCount, -1);
+		seenStamp.assign(cellCount, 0);
+		closedStamp.assign(cellCount, 0);
+		generation = 0;
+	}
+
+	generation++;
+	open.clear();
+	expandedCells = 0;
+}
+#endif
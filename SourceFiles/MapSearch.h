@@ -0,0 +1,156 @@
+#ifndef MAPSEARCH_H
+#define MAPSEARCH_H
+
+#include "Cell.h"
+#include "Heuristics.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdlib.h>
+#include <vector>
+
+/*
+Reusable per-thread working memory for searches that never write into the map they search.
+Cells are addressed by index (x + y * width). Arrays are only cleared when they have to grow,
+every other search just bumps the generation, so reusing a scratch costs nothing per query.
+*/
+class SearchScratch {
+public:
+	void Begin(int cellCount); /* Starts a new search over cellCount cells */
+
+	bool IsSeen(int index) const { return seenStamp[index] == generation; } /* Has this cell been given a g value this search */
+	bool IsClosed(int index) const { return closedStamp[index] == generation; } /* Has this cell been expanded this search */
+	void See(int index, int cost, int parentIndex) { seenStamp[index] = generation; g[index] = cost; parent[index] = parentIndex; } /* Records a new best cost */
+	void Close(int index) { closedStamp[index] = generation; } /* Marks a cell as expanded */
+
+	std::vector<int> g; /* Best known cost from the start, valid when IsSeen */
+	std::vector<int> parent; /* Index of the previous cell on the best path, -1 for the start */
+	std::vector<long long> open; /* Open list storage, kept between searches to avoid reallocating */
+	int expandedCells = 0; /* Cells expanded by the last search */
+private:
+	std::vector<unsigned int> seenStamp;
+	std::vector<unsigned int> closedStamp;
+	unsigned int generation = 0;
+};
+
+/*
+The A* behind MapAStarSearch: searches from (startX, startY) until (goalX, goalY) is expanded and returns true,
+leaving the path in scratch.parent, where index is x + y * GetGridX(). Returns false if the goal can't be reached.
+*/
+template <typename Map>
+bool MapAStarExpand(const Map &map, int startX, int startY, int goalX, int goalY, SearchScratch &scratch) {
+	int width = map.GetGridX();
+	int height = map.GetGridY();
+
+	if (startX < 0 || startX >= width || startY < 0 || startY >= height || goalX < 0 || goalX >= width || goalY < 0 || goalY >= height)
+		return false;
+
+	scratch.Begin(width * height);
+
+	int startIndex = startX + startY * width;
+	int goalIndex = goalX + goalY * width;
+
+	//Open entries pack f into the high bits and the cell index into the low bits, so one compare orders them
+	scratch.See(startIndex, 0, -1);
+	scratch.open.push_back(((long long)ManhattanDistance(startX, startY, goalX, goalY) << 32) | startIndex);
+
+	const int offsetX[4] = { -1, 0, 1, 0 };
+	const int offsetY[4] = { 0, -1, 0, 1 };
+
+	while (!scratch.open.empty()) {
+		std::pop_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		int current = (int)(scratch.open.back() & 0xFFFFFFFF);
+		scratch.open.pop_back();
+
+		if (scratch.IsClosed(current))
+			continue;
+
+		scratch.Close(current);
+		scratch.expandedCells++;
+
+		if (current == goalIndex)
+			return true;
+
+		int currentX = current % width;
+		int currentY = current / width;
+
+		for (int direction = 0;direction < 4;direction++) {
+			int x = currentX + offsetX[direction];
+			int y = currentY + offsetY[direction];
+			if (x < 0 || x >= width || y < 0 || y >= height)
+				continue;
+
+			int index = x + y * width;
+			if (scratch.IsClosed(index) || (index != goalIndex && !map.IsWalkable(x, y)))
+				continue;
+
+			int cost = scratch.g[current] + 1;
+			if (scratch.IsSeen(index) && scratch.g[index] <= cost)
+				continue;
+
+			scratch.See(index, cost, current);
+			long long f = cost + ManhattanDistance(x, y, goalX, goalY);
+			scratch.open.push_back((f << 32) | index);
+			std::push_heap(scratch.open.begin(), scratch.open.end(), std::greater<long long>());
+		}
+	}
+
+	return false;
+}
+
+/*
+A* from (startX, startY) to (goalX, goalY) over any map type providing
+	int GetGridX() const, int GetGridY() const and bool IsWalkable(int x, int y) const.
+Like Grid's searches, the goal may always be entered and the returned path excludes the start cell,
+unless start and goal are the same cell. Safe to run concurrently on the same map with separate scratches.
+*/
+template <typename Map>
+std::vector<Cell> MapAStarSearch(const Map &map, int startX, int startY, int goalX, int goalY, SearchScratch &scratch) {
+	std::vector<Cell> path;
+	if (!MapAStarExpand(map, startX, startY, goalX, goalY, scratch))
+		return path;
+
+	//Walk the parents back to the start, then put them in start-to-goal order
+	int width = map.GetGridX();
+	int startIndex = startX + startY * width;
+	for (int index = goalX + goalY * width;index != startIndex;index = scratch.parent[index])
+		path.push_back(Cell(index % width, index / width));
+
+	if (path.empty())
+		path.push_back(Cell(startX, startY));
+
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+/*
+MapAStarSearch writing the path as indices (x + y * GetGridX()) over the caller's buffer, reusing its memory,
+so a warmed-up scratch and buffer make a query allocation free. Returns false, leaving path alone, if there is no path.
+*/
+template <typename Map>
+bool MapAStarSearch(const Map &map, int startX, int startY, int goalX, int goalY, SearchScratch &scratch, std::vector<unsigned int> &path) {
+	if (!MapAStarExpand(map, startX, startY, goalX, goalY, scratch))
+		return false;
+
+	int width = map.GetGridX();
+	int startIndex = startX + startY * width;
+	int goalIndex = goalX + goalY * width;
+
+	int length = 0;
+	for (int index = goalIndex;index != startIndex;index = scratch.parent[index])
+		length++;
+
+	if (length == 0) {
+		path.assign(1, (unsigned int)startIndex);
+		return true;
+	}
+
+	//Fill from the goal end so the indices come out in start-to-goal order without a reverse
+	path.resize(length);
+	for (int index = goalIndex;index != startIndex;index = scratch.parent[index])
+		path[--length] = (unsigned int)index;
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef MULTIGOALSEARCH_CPP
+#define MULTIGOALSEARCH_CPP
+#include "MultiGoalSearch.h"
+
+#include <stdlib.h>
+
+GoalSet::GoalSet() {
+}
+
+GoalSet::GoalSet(int width, int height) {
+	Reset(width, height);
+}
+
+void GoalSet::Reset(int width, int height) {
+	this->width = width;
+	this->height = height;
+	bucketsX = (width + bucketSize - 1) / bucketSize;
+	bucketsY = (height + bucketSize - 1) / bucketSize;
+
+	bitmap.assign((width * height + 63) / 64, 0ULL);
+	goals.clear();
+	buckets.assign(bucketsX * bucketsY, std::vector<int>());
+}
+
+bool GoalSet::Add(int x, int y) {
+	if (x < 0 || x >= width || y < 0 || y >= height || Contains(x, y))
+		return false;
+
+	int index = x + y * width;
+	bitmap[index >> 6] |= 1ULL << (index & 63);
+	goals.push_back(Cell(x, y));
+	buckets[x / bucketSize + (y / bucketSize) * bucketsX].push_back(index);
+	return true;
+}
+
+bool GoalSet::Contains(int x, int y) const {
+	if (x < 0 || x >= width || y < 0 || y >= height)
+		return false;
+
+	return ContainsIndex(x + y * width);
+}
+
+int GoalSet::GetCount() const {
+	return (int)goals.size();
+}
+
+const std::vector<Cell> &GoalSet::GetGoals() const {
+	return goals;
+}
+
+int GoalSet::GetWidth() const {
+	return width;
+}
+
+int GoalSet::GetHeight() const {
+	return height;
+}
+
+int GoalSet::GetNearestDistance(int x, int y, const std::vector<int> &excluded) const {
+	if (goals.size() == excluded.size())
+		return -1;
+
+	int bucketX = x / bucketSize;
+	int bucketY = y / bucketSize;
+	int maxRing = std::max(std::max(bucketX, bucketsX - 1 - bucketX), std::max(bucketY, bucketsY - 1 - bucketY));
+	int best = -1;
+
+	//Look at buckets in rings of growing Chebyshev distance around (x, y)'s bucket
+	for (int ring = 0;ring <= maxRing;ring++) {
+		//Anything in ring r is at least (r - 1) * bucketSize + 1 cells away along one axis
+		if (ring > 0 && best >= 0 && best <= (ring - 1) * bucketSize + 1)
+			break;
+
+		for (int by = bucketY - ring;by <= bucketY + ring;by++) {
+			if (by < 0 || by >= bucketsY)
+				continue;
+
+			for (int bx = bucketX - ring;bx <= bucketX + ring;bx++) {
+				if (bx < 0 || bx >= bucketsX)
+					continue;
+				if (abs(bx - bucketX) != ring && abs(by - bucketY) != ring)
+					continue; //Inside the ring, already looked at
+
+				const std::vector<int> &bucket = buckets[bx + by * bucketsX];
+				for (int x2 = 0;x2 < bucket.size();x2++) {
+					int distance = abs(bucket[x2] % width - x) + abs(bucket[x2] / width - y);
+					if (best >= 0 && distance >= best)
+						continue;
+					if (std::find(excluded.begin(), excluded.end(), bucket[x2]) != excluded.end())
+						continue;
+
+					best = distance;
+				}
+			}
+		}
+	}
+
+	return best;
+}
+#endif
@@ -0,0 +1,187 @@
+#ifndef PATHENCODING_CPP
+#define PATHENCODING_CPP
+#include "PathEncoding.h"
+
+//Direction code of a single move, in the order ForEachStep's offsets use. -1 if it isn't a move to a neighbor
+static int GetDirection(int dx, int dy) {
+	static const int codes[3][3] = {
+		{ 4, 0, 7 }, //dx -1: up-left, left, down-left
+		{ 1, -1, 3 }, //dx 0: up, none, down
+		{ 5, 2, 6 } //dx 1: up-right, right, down-right
+	};
+
+	if (dx < -1 || dx > 1 || dy < -1 || dy > 1)
+		return -1;
+
+	return codes[dx + 1][dy + 1];
+}
+
+template <typename Step>
+bool EncodedPath::EncodeSteps(int startX, int startY, int count, Step getStep) {
+	Clear();
+
+	//First pass checks every move and finds out whether 3-bit directions are needed
+	bool anyDiagonal = false;
+	int x = startX;
+	int y = startY;
+	for (int step = 0;step < count;step++) {
+		int nextX;
+		int nextY;
+		getStep(step, nextX, nextY);
+
+		int direction = GetDirection(nextX - x, nextY - y);
+		if (direction < 0)
+			return false;
+
+		anyDiagonal = anyDiagonal || direction >= 4;
+		x = nextX;
+		y = nextY;
+	}
+
+	this->startX = startX;
+	this->startY = startY;
+	stepCount = count;
+	diagonal = anyDiagonal;
+	hasPath = true;
+
+	//Second pass writes one run per change of direction
+	x = startX;
+	y = startY;
+	int runDirection = -1;
+	unsigned int run = 0;
+	for (int step = 0;step < count;step++) {
+		int nextX;
+		int nextY;
+		getStep(step, nextX, nextY);
+
+		int direction = GetDirection(nextX - x, nextY - y);
+		if (direction != runDirection && run > 0) {
+			WriteBits(runDirection, diagonal ? 3 : 2);
+			WriteRunLength(run);
+			run = 0;
+		}
+
+		runDirection = direction;
+		run++;
+		x = nextX;
+		y = nextY;
+	}
+
+	if (run > 0) {
+		WriteBits(runDirection, diagonal ? 3 : 2);
+		WriteRunLength(run);
+	}
+
+	bits.shrink_to_fit();
+	return true;
+}
+
+bool EncodedPath::Encode(Cell start, const std::vector<Cell> &path) {
+	if (path.empty()) {
+		Clear();
+		return true;
+	}
+
+	//A lone start cell is the start-is-goal path, no moves at all
+	if (path.size() == 1 && path[0].x == start.x && path[0].y == start.y)
+		return EncodeSteps(start.x, start.y, 0, [&](int step, int &x, int &y) {});
+
+	return EncodeSteps(start.x, start.y, (int)path.size(), [&](int step, int &x, int &y) { x = path[step].x; y = path[step].y; });
+}
+
+bool EncodedPath::EncodeIndices(int width, unsigned int start, const std::vector<unsigned int> &path) {
+	if (path.empty()) {
+		Clear();
+		return true;
+	}
+
+	int startX = (int)(start % width);
+	int startY = (int)(start / width);
+	if (path.size() == 1 && path[0] == start)
+		return EncodeSteps(startX, startY, 0, [&](int step, int &x, int &y) {});
+
+	return EncodeSteps(startX, startY, (int)path.size(), [&](int step, int &x, int &y) { x = (int)(path[step] % width); y = (int)(path[step] / width); });
+}
+
+void EncodedPath::Clear() {
+	startX = 0;
+	startY = 0;
+	stepCount = 0;
+	hasPath = false;
+	diagonal = false;
+	bitCount = 0;
+	std::vector<unsigned char>().swap(bits);
+}
+
+bool EncodedPath::IsEmpty() const {
+	return !hasPath;
+}
+
+Cell EncodedPath::GetStart() const {
+	return Cell(startX, startY);
+}
+
+int EncodedPath::GetStepCount() const {
+	return stepCount;
+}
+
+bool EncodedPath::HasDiagonalSteps() const {
+	return diagonal;
+}
+
+size_t EncodedPath::GetByteCount() const {
+	return bits.size();
+}
+
+void EncodedPath::Decode(std::vector<Cell> &path) const {
+	path.clear();
+	if (!hasPath)
+		return;
+
+	if (stepCount == 0) {
+		path.push_back(Cell(startX, startY));
+		return;
+	}
+
+	path.reserve(stepCount);
+	ForEachStep([&](int x, int y) { path.push_back(Cell(x, y)); });
+}
+
+void EncodedPath::DecodeIndices(int width, std::vector<unsigned int> &path) const {
+	path.clear();
+	if (!hasPath)
+		return;
+
+	if (stepCount == 0) {
+		path.push_back((unsigned int)(startX + startY * width));
+		return;
+	}
+
+	path.reserve(stepCount);
+	ForEachStep([&](int x, int y) { path.push_back((unsigned int)(x + y * width)); });
+}
+
+void EncodedPath::WriteBits(unsigned int value, int count) {
+	for (int x = 0;x < count;x++, bitCount++) {
+		if ((bitCount >> 3) >= bits.size())
+			bits.push_back(0);
+
+		bits[bitCount >> 3] |= (unsigned char)(((value >> x) & 1u) << (bitCount & 7));
+	}
+}
+
+void EncodedPath::WriteRunLength(unsigned int run) {
+	int topBit = 0;
+	while ((run >> (topBit + 1)) != 0)
+		topBit++;
+
+	//As many zeros as there are bits after the leading 1, then the bits highest first
+	for (int x = 0;x < topBit;x++, bitCount++) {
+		if ((bitCount >> 3) >= bits.size())
+			bits.push_back(0);
+	}
+
+	for (int x = topBit;x >= 0;x--)
+		WriteBits((run >> x) & 1u, 1);
+}
+#endif
@@ -0,0 +1,55 @@
+#ifndef PATHQUERY_H
+#define PATHQUERY_H
+
+#include "Grid.h"
+#include "CancellationToken.h"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/* How urgent a query is. Higher priorities are always dequeued before lower ones */
+enum class QueryPriority : char {
+	background = 0,
+	normal = 1,
+	player = 2
+};
+
+/* What ended up happening to a query */
+enum class QueryStatus : char {
+	completed, /* Searched with the requested algorithm */
+	degraded, /* Searched with GreedySearch because the scheduler was overloaded */
+	dropped, /* Deadline had already passed when a worker picked it up, never searched */
+	rejected, /* Refused by admission control, or the positions were outside of the grid */
+	cancelled, /* Stopped by the query's cancellation token being cancelled */
+	timedOut /* Stopped by the query's cancellation token timing out */
+};
+
+class PathQueryResult;
+
+/* A single start-to-goal request handed to the QueryScheduler */
+class PathQuery {
+public:
+	int startX = 0; /* X Coordinate of the start cell */
+	int startY = 0; /* Y Coordinate of the start cell */
+	int goalX = 0; /* X Coordinate of the goal cell */
+	int goalY = 0; /* Y Coordinate of the goal cell */
+	SearchAlgorithm algorithm = SearchAlgorithm::aStar; /* The algorithm to use when not overloaded */
+	QueryPriority priority = QueryPriority::normal; /* Urgency of the query */
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(); /* Answer is useless after this point */
+	bool allowDegrade = true; /* If true, the scheduler may answer with GreedySearch when overloaded */
+	std::shared_ptr<CancellationToken> cancellationToken; /* Optional, lets the caller abandon the query while queued or being searched */
+	std::function<void(const PathQueryResult &)> onComplete; /* Called on a worker thread once the query is answered */
+};
+
+/* The answer to a PathQuery */
+class PathQueryResult {
+public:
+	QueryStatus status = QueryStatus::completed; /* What happened to the query */
+	SearchAlgorithm algorithmUsed = SearchAlgorithm::aStar; /* The algorithm that actually produced the path */
+	std::vector<Cell> path; /* The path found, empty if none was found or the query was not searched */
+	bool missedDeadline = false; /* True if the answer was produced after the query's deadline */
+};
+
+#endif
@@ -0,0 +1,413 @@
+#ifndef QUERYSCHEDULER_CPP
+#define QUERYSCHEDULER_CPP
+#include "QueryScheduler.h"
+
+QueryScheduler::QueryScheduler(const Grid &grid) {
+	StartWorkers(grid, (int)std::thread::hardware_concurrency());
+}
+
+QueryScheduler::QueryScheduler(const Grid &grid, int workerCount) {
+	StartWorkers(grid, workerCount);
+}
+
+QueryScheduler::~QueryScheduler() {
+	Shutdown();
+}
+
+void QueryScheduler::StartWorkers(const Grid &grid, int workerCount) {
+	//hardware_concurrency is allowed to report 0, always run at least one worker
+	if (workerCount < 1)
+		workerCount = 1;
+
+	sharedGrid = grid;
+	sharedGrid.SetOutputSearchDiagnostics(false); //Workers never own the console
+	sharedGrid.SetDisplayAllTraversedCells(false);
+
+	//Every worker gets its own copy, as searching writes visited flags and parents into the grid's cells
+	for (int x = 0;x < workerCount;x++) {
+		workers.push_back(std::unique_ptr<Worker>(new Worker()));
+		workers[x]->grid = sharedGrid;
+		workers[x]->gridVersion = gridVersion;
+	}
+
+	//Only start the threads once the worker vector is complete, as they steal from each other
+	for (int x = 0;x < workerCount;x++) {
+		workers[x]->thread = std::thread(&QueryScheduler::WorkerLoop, this, x);
+	}
+}
+
+bool QueryScheduler::Submit(PathQuery query) {
+	if (!Admit(query))
+		return false;
+
+	//Spread submissions across the worker queues, idle workers will steal anything left waiting
+	Worker &worker = *workers[nextWorker++ % workers.size()];
+	QueuedQuery queued = Enqueue(query);
+	bool pushed = false;
+	{
+		//Shutdown drains the queues after setting stopping, so checked under the lock nothing can land in a drained queue
+		std::lock_guard<std::mutex> lock(worker.queueMutex);
+		if (!stopping) {
+			worker.queue.push_back(std::move(queued));
+			std::push_heap(worker.queue.begin(), worker.queue.end(), IsLessUrgent);
+			pushed = true;
+		}
+	}
+
+	if (!pushed) {
+		Abandon(queued);
+		return true;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+	}
+	wakeCondition.notify_one();
+
+	return true;
+}
+
+int QueryScheduler::SubmitBatch(std::vector<PathQuery> queries) {
+	//Admit everything first, then hand each worker its share under a single lock
+	std::vector<std::vector<QueuedQuery>> shares = std::vector<std::vector<QueuedQuery>>(workers.size());
+	int accepted = 0;
+
+	for (int x = 0;x < queries.size();x++) {
+		if (!Admit(queries[x]))
+			continue;
+
+		shares[nextWorker++ % workers.size()].push_back(Enqueue(queries[x]));
+		accepted++;
+	}
+
+	for (int x = 0;x < workers.size();x++) {
+		if (shares[x].empty())
+			continue;
+
+		{
+			std::lock_guard<std::mutex> lock(workers[x]->queueMutex);
+			for (int y = 0;y < shares[x].size() && !stopping;y++) {
+				workers[x]->queue.push_back(std::move(shares[x][y]));
+				std::push_heap(workers[x]->queue.begin(), workers[x]->queue.end(), IsLessUrgent);
+			}
+
+			if (!stopping)
+				shares[x].clear();
+		}
+
+		//Shutdown started while this batch was being admitted
+		for (int y = 0;y < shares[x].size();y++)
+			Abandon(shares[x][y]);
+	}
+
+	if (accepted > 0) {
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+		}
+		wakeCondition.notify_all();
+	}
+
+	return accepted;
+}
+
+bool QueryScheduler::Admit(PathQuery &query) {
+	submitted++;
+
+	bool inBounds;
+	{
+		std::lock_guard<std::mutex> lock(gridMutex);
+		inBounds = query.startX >= 0 && query.startX < sharedGrid.GetGridX() && query.startY >= 0 && query.startY < sharedGrid.GetGridY()
+			&& query.goalX >= 0 && query.goalX < sharedGrid.GetGridX() && query.goalY >= 0 && query.goalY < sharedGrid.GetGridY();
+	}
+
+	//Admission control: once the queue is full, only player queries get in
+	int maxDepth = maxQueueDepth.load();
+	bool queueFull = maxDepth > 0 && queueDepth.load() >= maxDepth && query.priority != QueryPriority::player;
+
+	if (!inBounds || queueFull || stopping) {
+		rejected++;
+
+		PathQueryResult result;
+		result.status = QueryStatus::rejected;
+		result.algorithmUsed = query.algorithm;
+		if (query.onComplete)
+			query.onComplete(result);
+
+		return false;
+	}
+
+	return true;
+}
+
+QueryScheduler::QueuedQuery QueryScheduler::Enqueue(PathQuery &query) {
+	QueuedQuery queued;
+	queued.query = std::move(query);
+	queued.sequence = nextSequence++;
+
+	//Count the query before it becomes visible, so a worker can never finish it before it is counted
+	outstanding++;
+	int depth = ++queueDepth;
+	int peak = peakQueueDepth.load();
+	while (depth > peak && !peakQueueDepth.compare_exchange_weak(peak, depth)) {
+	}
+
+	return queued;
+}
+
+SearchFuture QueryScheduler::SubmitAsync(PathQuery query) {
+	std::shared_ptr<SearchState> state = std::make_shared<SearchState>();
+
+	if (query.cancellationToken == nullptr)
+		query.cancellationToken = std::make_shared<CancellationToken>();
+	state->cancellationToken = query.cancellationToken;
+
+	//Chain onto any callback the caller already set, then complete the future
+	std::function<void(const PathQueryResult &)> onComplete = std::move(query.onComplete);
+	query.onComplete = [state, onComplete](const PathQueryResult &result) {
+		if (onComplete)
+			onComplete(result);
+		state->Complete(result);
+	};
+
+	Submit(std::move(query));
+	return SearchFuture(state);
+}
+
+void QueryScheduler::SetGrid(const Grid &grid) {
+	std::lock_guard<std::mutex> lock(gridMutex);
+	sharedGrid = grid;
+	sharedGrid.SetOutputSearchDiagnostics(false);
+	sharedGrid.SetDisplayAllTraversedCells(false);
+	gridVersion++;
+}
+
+void QueryScheduler::SetMaxQueueDepth(int depth) {
+	maxQueueDepth = depth;
+}
+
+int QueryScheduler::GetMaxQueueDepth() {
+	return maxQueueDepth;
+}
+
+void QueryScheduler::SetDegradeQueueDepth(int depth) {
+	degradeQueueDepth = depth;
+}
+
+int QueryScheduler::GetDegradeQueueDepth() {
+	return degradeQueueDepth;
+}
+
+int QueryScheduler::GetWorkerCount() {
+	return (int)workers.size();
+}
+
+SchedulerStats QueryScheduler::GetStats() {
+	SchedulerStats stats;
+	stats.queueDepth = queueDepth;
+	stats.peakQueueDepth = peakQueueDepth;
+	stats.submitted = submitted;
+	stats.completed = completed;
+	stats.degraded = degraded;
+	stats.dropped = dropped;
+	stats.rejected = rejected;
+	stats.cancelled = cancelled;
+	stats.deadlineMisses = deadlineMisses;
+
+	//The arenas are thread_local, so each worker publishes its own counters and we only add them up
+	for (int x = 0;x < workers.size();x++) {
+		stats.searchHeapAllocations += workers[x]->arenaHeapAllocations;
+		stats.searchArenaBytes += workers[x]->arenaBytes;
+	}
+	return stats;
+}
+
+void QueryScheduler::WaitUntilIdle() {
+	std::unique_lock<std::mutex> lock(wakeMutex);
+	idleCondition.wait(lock, [this]() { return outstanding.load() == 0 || stopping; });
+}
+
+void QueryScheduler::Shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		if (stopping)
+			return;
+		stopping = true;
+	}
+	wakeCondition.notify_all();
+
+	for (int x = 0;x < workers.size();x++) {
+		if (workers[x]->thread.joinable())
+			workers[x]->thread.join();
+	}
+
+	//Anything still queued will never be searched. Answer it as cancelled, so callbacks run and futures resolve
+	for (int x = 0;x < workers.size();x++) {
+		std::vector<QueuedQuery> abandoned;
+		{
+			std::lock_guard<std::mutex> lock(workers[x]->queueMutex);
+			abandoned.swap(workers[x]->queue);
+		}
+
+		for (int y = 0;y < abandoned.size();y++)
+			Abandon(abandoned[y]);
+	}
+
+	idleCondition.notify_all();
+}
+
+void QueryScheduler::WorkerLoop(int index) {
+	for (;;) {
+		QueuedQuery queued;
+		if (PopQuery(index, queued)) {
+			RunQuery(*workers[index], queued);
+
+			//Wake anyone in WaitUntilIdle once the last query is answered
+			if (--outstanding == 0) {
+				std::lock_guard<std::mutex> lock(wakeMutex);
+				idleCondition.notify_all();
+			}
+			continue;
+		}
+
+		//Nothing to run or steal, sleep until something is queued
+		std::unique_lock<std::mutex> lock(wakeMutex);
+		wakeCondition.wait(lock, [this]() { return stopping || queueDepth.load() > 0; });
+		if (stopping)
+			return;
+	}
+}
+
+bool QueryScheduler::PopQuery(int index, QueuedQuery &out) {
+	//Peek at the top of every queue, preferring our own queue on ties.
+	//A busy worker's queue still gets drained by whoever is free, which is the stealing half of the pool.
+	int best = -1;
+	QueuedQuery bestTop;
+
+	for (int offset = 0;offset < workers.size();offset++) {
+		int victim = (index + offset) % workers.size();
+		std::lock_guard<std::mutex> lock(workers[victim]->queueMutex);
+
+		if (workers[victim]->queue.empty())
+			continue;
+
+		if (best == -1 || IsLessUrgent(bestTop, workers[victim]->queue.front())) {
+			best = victim;
+			bestTop.query.priority = workers[victim]->queue.front().query.priority;
+			bestTop.query.deadline = workers[victim]->queue.front().query.deadline;
+			bestTop.sequence = workers[victim]->queue.front().sequence;
+		}
+	}
+
+	if (best == -1)
+		return false;
+
+	//The queue may have changed since we peeked, take whatever is most urgent in it now
+	std::lock_guard<std::mutex> lock(workers[best]->queueMutex);
+	if (workers[best]->queue.empty())
+		return false;
+
+	std::pop_heap(workers[best]->queue.begin(), workers[best]->queue.end(), IsLessUrgent);
+	out = std::move(workers[best]->queue.back());
+	workers[best]->queue.pop_back();
+	queueDepth--;
+
+	return true;
+}
+
+void QueryScheduler::RunQuery(Worker &worker, QueuedQuery &queued) {
+	PathQuery &query = queued.query;
+
+	PathQueryResult result;
+	result.algorithmUsed = query.algorithm;
+
+	//Stale queries are dropped rather than searched, the caller has already moved on
+	if (std::chrono::steady_clock::now() > query.deadline) {
+		result.status = QueryStatus::dropped;
+		result.missedDeadline = true;
+		dropped++;
+		deadlineMisses++;
+		Finish(query, result);
+		return;
+	}
+
+	//Cancelled while it was still queued, don't bother searching
+	CancellationToken *token = query.cancellationToken.get();
+	if (token != nullptr && token->ShouldStop()) {
+		result.status = token->IsCancelled() ? QueryStatus::cancelled : QueryStatus::timedOut;
+		cancelled++;
+		Finish(query, result);
+		return;
+	}
+
+	//Pick up the latest grid if it changed since this worker's last query
+	{
+		std::lock_guard<std::mutex> lock(gridMutex);
+		if (worker.gridVersion != gridVersion) {
+			worker.grid = sharedGrid;
+			worker.gridVersion = gridVersion;
+		}
+	}
+
+	//When overloaded, answer degradable queries with the cheaper greedy search
+	int degradeDepth = degradeQueueDepth.load();
+	if (query.allowDegrade && degradeDepth > 0 && queueDepth.load() >= degradeDepth && query.algorithm != SearchAlgorithm::greedy) {
+		result.status = QueryStatus::degraded;
+		result.algorithmUsed = SearchAlgorithm::greedy;
+	}
+
+	worker.grid.SetStartPos(query.startX, query.startY);
+	worker.grid.SetGoalPos(query.goalX, query.goalY);
+	worker.grid.SetCancellationToken(token);
+	result.path = worker.grid.Search(result.algorithmUsed);
+	worker.grid.SetCancellationToken(nullptr);
+
+	ArenaStats arenaStats = SearchArena::ForThisThread().GetStats();
+	worker.arenaHeapAllocations = arenaStats.heapAllocations;
+	worker.arenaBytes = (long long)arenaStats.capacity;
+
+	if (worker.grid.WasLastSearchCancelled()) {
+		result.status = token->IsCancelled() ? QueryStatus::cancelled : QueryStatus::timedOut;
+		cancelled++;
+		Finish(query, result);
+		return;
+	}
+
+	if (result.status == QueryStatus::degraded)
+		degraded++;
+	else
+		completed++;
+
+	if (std::chrono::steady_clock::now() > query.deadline) {
+		result.missedDeadline = true;
+		deadlineMisses++;
+	}
+
+	Finish(query, result);
+}
+
+void QueryScheduler::Abandon(QueuedQuery &queued) {
+	queueDepth--;
+	outstanding--;
+	cancelled++;
+
+	PathQueryResult result;
+	result.status = QueryStatus::cancelled;
+	result.algorithmUsed = queued.query.algorithm;
+	Finish(queued.query, result);
+}
+
+void QueryScheduler::Finish(PathQuery &query, PathQueryResult &result) {
+	if (query.onComplete)
+		query.onComplete(result);
+}
+
+bool QueryScheduler::IsLessUrgent(const QueuedQuery &a, const QueuedQuery &b) {
+	if (a.query.priority != b.query.priority)
+		return a.query.priority < b.query.priority;
+
+	if (a.query.deadline != b.query.deadline)
+		return a.query.deadline > b.query.deadline;
+
+	return a.sequence > b.sequence;
+}
+#endif
@@ -0,0 +1,97 @@
+#ifndef SEARCHARENA_CPP
+#define SEARCHARENA_CPP
+#include "SearchArena.h"
+
+#include <algorithm>
+
+const size_t SearchArena::blockSize;
+
+SearchArena::SearchArena() {
+	for (int x = 0;x < sizeClassCount;x++)
+		freeLists[x] = nullptr;
+}
+
+void *SearchArena::Allocate(size_t bytes) {
+	int sizeClass = GetSizeClass(bytes);
+	size_t size = (size_t)16 << sizeClass;
+	stats.arenaAllocations++;
+
+	//The node pool first: anything of this class freed since the last Reset
+	if (freeLists[sizeClass] != nullptr) {
+		FreeNode *node = freeLists[sizeClass];
+		freeLists[sizeClass] = node->next;
+		stats.pooledReuses++;
+		return node;
+	}
+
+	if (remaining < size)
+		AddBlock(size);
+
+	void *pointer = cursor;
+	cursor += size;
+	remaining -= size;
+
+	stats.bytesInUse += size;
+	stats.peakBytesInUse = std::max(stats.peakBytesInUse, stats.bytesInUse);
+	return pointer;
+}
+
+void SearchArena::Free(void *pointer, size_t bytes) {
+	if (pointer == nullptr)
+		return;
+
+	int sizeClass = GetSizeClass(bytes);
+	FreeNode *node = (FreeNode *)pointer;
+	node->next = freeLists[sizeClass];
+	freeLists[sizeClass] = node;
+}
+
+void SearchArena::Reset() {
+	for (int x = 0;x < sizeClassCount;x++)
+		freeLists[x] = nullptr;
+
+	//Fold several blocks into one, so the next query like this one stays in a single block
+	if (blocks.size() > 1) {
+		size_t total = stats.capacity;
+		blocks.clear();
+		blockSizes.clear();
+		stats.capacity = 0;
+		AddBlock(total);
+	}
+	else if (!blocks.empty()) {
+		cursor = blocks[0].get();
+		remaining = blockSizes[0];
+	}
+
+	stats.bytesInUse = 0;
+	stats.resets++;
+}
+
+ArenaStats SearchArena::GetStats() const {
+	return stats;
+}
+
+SearchArena &SearchArena::ForThisThread() {
+	static thread_local SearchArena arena;
+	return arena;
+}
+
+int SearchArena::GetSizeClass(size_t bytes) {
+	int sizeClass = 0;
+	while (((size_t)16 << sizeClass) < bytes)
+		sizeClass++;
+
+	return sizeClass;
+}
+
+void SearchArena::AddBlock(size_t bytes) {
+	size_t size = std::max(bytes, blockSize);
+	blocks.push_back(std::unique_ptr<char[]>(new char[size]));
+	blockSizes.push_back(size);
+
+	cursor = blocks.back().get();
+	remaining = size;
+	stats.capacity += size;
+	stats.heapAllocations++;
+}
+#endif
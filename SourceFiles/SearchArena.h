@@ -0,0 +1,88 @@
+#ifndef SEARCHARENA_H
+#define SEARCHARENA_H
+
+#include <memory>
+#include <stddef.h>
+#include <vector>
+
+/* A snapshot of a SearchArena's counters */
+class ArenaStats {
+public:
+	long long heapAllocations = 0; /* Blocks taken from the global heap. Stops growing once the arena has warmed up */
+	long long arenaAllocations = 0; /* Requests served from the arena, by bumping or from a free list */
+	long long pooledReuses = 0; /* Requests served by recycling a freed node of the same size class */
+	long long resets = 0; /* Times Reset was called */
+	size_t bytesInUse = 0; /* Bytes bumped since the last Reset */
+	size_t peakBytesInUse = 0; /* Largest bytesInUse seen */
+	size_t capacity = 0; /* Bytes held from the global heap */
+};
+
+/*
+Per-thread working memory for search containers: a bump allocator over large blocks, plus a node pool.
+Sizes are rounded up to a power of two of at least 16 bytes, and freed memory goes on a free list for its size class,
+so a deque's fixed-size chunks and a vector's regrown buffers are recycled within a query instead of piling up.
+
+Reset drops every allocation at once and keeps the memory. If a query needed more than one block, Reset
+replaces them with a single block as large as all of them, so from then on a query of that size bumps through
+one block and never goes back to the global heap.
+Not thread-safe, each thread uses its own through ForThisThread.
+*/
+class SearchArena {
+public:
+	static const size_t blockSize = 64 * 1024;
+
+	SearchArena();
+
+	void *Allocate(size_t bytes); /* Returns memory aligned like operator new's, valid until Reset */
+	void Free(void *pointer, size_t bytes); /* Hands memory from Allocate back to its size class's free list */
+	void Reset(); /* Forgets every allocation. Nothing allocated before may still be in use */
+
+	ArenaStats GetStats() const;
+
+	static SearchArena &ForThisThread(); /* The calling thread's arena, made on first use */
+private:
+	SearchArena(const SearchArena &) = delete;
+	SearchArena &operator=(const SearchArena &) = delete;
+
+	static int GetSizeClass(size_t bytes); /* Smallest class whose size, 16 << class, holds bytes */
+	void AddBlock(size_t bytes); /* Takes a new block of at least bytes from the global heap and bumps from it */
+
+	/* A freed node, linked through its own first bytes */
+	class FreeNode {
+	public:
+		FreeNode *next;
+	};
+
+	static const int sizeClassCount = 48;
+
+	std::vector<std::unique_ptr<char[]>> blocks;
+	std::vector<size_t> blockSizes;
+	char *cursor = nullptr; /* Next free byte of the newest block */
+	size_t remaining = 0; /* Bytes left after cursor in the newest block */
+	FreeNode *freeLists[sizeClassCount];
+	ArenaStats stats;
+};
+
+/* A standard allocator drawing from a SearchArena, so std::deque, std::stack, std::queue and std::vector can live in one */
+template <typename T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+
+	ArenaAllocator(SearchArena &arena) : arena(&arena) {}
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+	T *allocate(size_t count) { return (T *)arena->Allocate(count * sizeof(T)); }
+	void deallocate(T *pointer, size_t count) { arena->Free(pointer, count * sizeof(T)); }
+
+	SearchArena *arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena == b.arena; }
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena != b.arena; }
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef SEARCHFUTURE_CPP
+#define SEARCHFUTURE_CPP
+#include "SearchFuture.h"
+#include "QueryScheduler.h"
+
+void SearchState::Complete(PathQueryResult result) {
+	std::function<void()> toRun;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->result = std::move(result);
+		ready = true;
+		toRun = std::move(continuation);
+	}
+	readyCondition.notify_all();
+
+	//Run the continuation outside of the lock, a resumed coroutine may well touch this state again
+	if (toRun)
+		toRun();
+}
+
+bool SearchState::SetContinuation(std::function<void()> continuation) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (ready)
+		return false;
+
+	this->continuation = std::move(continuation);
+	return true;
+}
+
+SearchFuture::SearchFuture() {
+}
+
+SearchFuture::SearchFuture(std::shared_ptr<SearchState> state) {
+	this->state = state;
+}
+
+bool SearchFuture::IsValid() {
+	return state != nullptr;
+}
+
+bool SearchFuture::IsReady() {
+	std::lock_guard<std::mutex> lock(state->mutex);
+	return state->ready;
+}
+
+void SearchFuture::Wait() {
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->readyCondition.wait(lock, [this]() { return state->ready; });
+}
+
+bool SearchFuture::WaitFor(std::chrono::steady_clock::duration timeout) {
+	std::unique_lock<std::mutex> lock(state->mutex);
+	return state->readyCondition.wait_for(lock, timeout, [this]() { return state->ready; });
+}
+
+PathQueryResult SearchFuture::Get() {
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->readyCondition.wait(lock, [this]() { return state->ready; });
+	return state->result;
+}
+
+void SearchFuture::Cancel() {
+	if (state->cancellationToken != nullptr)
+		state->cancellationToken->Cancel();
+}
+
+std::shared_ptr<CancellationToken> SearchFuture::GetCancellationToken() {
+	return state->cancellationToken;
+}
+
+bool SearchFuture::await_ready() {
+	return IsReady();
+}
+
+PathQueryResult SearchFuture::await_resume() {
+	return Get();
+}
+
+SearchFuture SearchAsync(QueryScheduler &scheduler, Cell start, Cell goal, SearchAlgorithm algorithm) {
+	return SearchAsync(scheduler, start, goal, algorithm, std::chrono::steady_clock::duration::max());
+}
+
+SearchFuture SearchAsync(QueryScheduler &scheduler, Cell start, Cell goal, SearchAlgorithm algorithm, std::chrono::steady_clock::duration timeout) {
+	//Run on the scheduler's workers rather than a thread of our own, so the thread count stays bounded,
+	//the workers' search arenas stay warm, and nothing is left running once the scheduler shuts down
+	PathQuery query;
+	query.startX = start.x;
+	query.startY = start.y;
+	query.goalX = goal.x;
+	query.goalY = goal.y;
+	query.algorithm = algorithm;
+	query.allowDegrade = false;
+	query.cancellationToken = std::make_shared<CancellationToken>();
+	if (timeout != std::chrono::steady_clock::duration::max())
+		query.cancellationToken->SetTimeout(timeout);
+
+	return scheduler.SubmitAsync(std::move(query));
+}
+#endif
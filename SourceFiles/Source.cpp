@@ -1,4 +1,5 @@
 #include "Grid.h"
+#include "LayoutBenchmark.h"
 #include "UserInput.h"
 
 int main() {
@@ -14,13 +15,20 @@ int main() {
 		
 		//Prompt the user with an arrow-key driven menu, asking to start the the project or exit the scene.
 		int selection = userInput.PromptUserMenu("Patrick Hosking's AI Assignment 2.\nImplementation of Greedy and A* search algorithms.\n\nFor some menus you will use ARROW KEYS with SPACE or RETURN to confirm selection.\n\nPlease choose a selection...",
-			std::vector<std::string>{"Run Scenario", "Exit Application"});
+			std::vector<std::string>{"Run Scenario", "Benchmark Grid Layouts", "Exit Application"});
 
 		switch (selection) {
 		case 0:
 			userInput.PromptGridInteractionGUI();
 			break;
 		case 1:
+			system("cls");
+			std::cout << "Timing breadth first searches on a 4096x4096 map under each grid layout, this takes a while...\n\n";
+			PrintLayoutBenchmark(std::cout, BenchmarkGridLayouts(4096, 4096, 3));
+			std::cout << std::endl;
+			system("pause");
+			break;
+		case 2:
 			out = false;
 			break;
 		default:
@@ -2,6 +2,12 @@
 #define USERINPUT_CPP
 #include "UserInput.h"
 
+#include "AnyAngleSearch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
 UserInput::UserInput() {
 	inputHandle = GetStdHandle(STD_INPUT_HANDLE);
 	outputHandle = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -191,6 +197,7 @@ bool UserInput::PromptGridInteractionGUI() {
 				<<"S: Set start position\nG: Set goal position\nR: Resize the grid (clears all placed objects)\n"
 				<< "D: Run a depth-first search on the current grid\nB: Run a breadth-first search on the current grid\n"
 				<< "Y: Run a greedy search on the current grid\nA: Run an A* search on the current grid\n"
+				<< "T: Run an any-angle (Lazy Theta*) search on the current grid\n"
 				<<"K: Add randomized walls\nV: Toggle cell visitation output (Currently: "<<(std::string)(grid.GetDisplayAllTraversedCells()?"ENABLED":"DISABLED")<<")\n"
 				<<"ESCAPE: EXIT this interaction and return to Main Menu" << std::endl;
 
@@ -511,6 +518,64 @@ bool UserInput::PromptGridInteractionGUI() {
 			system("pause>nul");
 			reprintGrid = true;
 
+		} else if (GetAsyncKeyState(84) || GetAsyncKeyState(116)) { //T or t key
+			MoveCursor(searchOutputLocation.X, searchOutputLocation.Y);
+
+			SetConsoleColor(14);
+			std::cout << "\nTesting ANY-ANGLE (Lazy Theta*) Search:\n";
+			SetConsoleColor(7);
+
+			//Lazy Theta* only needs to know which cells are walls, and checks line of sight far faster on a bitmap of them
+			WallBitmap walls;
+			walls.Build(grid);
+			SearchScratch scratch;
+			Cell start = grid.GetStartPos();
+			Cell goal = grid.GetGoalPos();
+
+			//Obtain the turning points of the path to the goal, which are joined by straight lines at any angle
+			std::vector<Cell> path = LazyThetaStarSearch(walls, start.x, start.y, goal.x, goal.y, scratch);
+			if (path.size() > 0) { //path found
+				double length = 0;
+				Cell from = start;
+				for (int x = 0;x < path.size();x++) {
+					length += std::sqrt((double)(path[x].x - from.x) * (path[x].x - from.x) + (double)(path[x].y - from.y) * (path[x].y - from.y));
+					from = path[x];
+				}
+
+				std::cout << "\n\nPath Found!\nTurning Points: " << path.size() << "\nPath Length: " << std::fixed << std::setprecision(2) << length << "\nPath: ";
+				std::cout.unsetf(std::ios::fixed);
+
+				//Output the turning points to the user
+				for (int x = 0;x < path.size();x++) {
+					std::cout << "(" << path[x].x << ", " << path[x].y << ((x == path.size() - 1) ? ")[Goal]\n\n" : ") -> ");
+				}
+
+				SetConsoleColor(12);
+				std::cout << "PRESS ANY KEY TO CONTINUE";
+
+				//outputs dashes along each straight leg, leaving the start and goal characters alone
+				from = start;
+				for (int x = 0;x < path.size();x++) {
+					int steps = std::max(std::abs(path[x].x - from.x), std::abs(path[x].y - from.y));
+					for (int step = 1;step <= steps;step++) {
+						int cellX = from.x + (int)std::floor((double)(path[x].x - from.x) * step / steps + 0.5);
+						int cellY = from.y + (int)std::floor((double)(path[x].y - from.y) * step / steps + 0.5);
+						if (cellX != goal.x || cellY != goal.y)
+							OutputNewCharacter(gridOrigin.X + cellX, gridOrigin.Y + cellY, '-', 10);
+					}
+					from = path[x];
+				}
+			} else { //path not found
+				std::cout << "\n\nUnable to find a path to goal...\n";
+				SetConsoleColor(12);
+				std::cout << "PRESS ANY KEY TO CONTINUE";
+			}
+
+			//reset color value, wait for user input, and flag for reprinting the grid to clear diagnostics
+			SetConsoleColor(7);
+			system("pause>nul");
+			reprintGrid = true;
+
 		} else if (GetAsyncKeyState(75) || GetAsyncKeyState(107)) { //K or k key
 			grid.PepperWalls();
 			reprintGrid = true;
@@ -0,0 +1,128 @@
+#ifndef VERSIONEDGRID_H
+#define VERSIONEDGRID_H
+
+#include "Cell.h"
+#include "Grid.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/* A square block of tiles. Never modified once it belongs to a published snapshot */
+class GridChunk {
+public:
+	static const int size = 32; /* Width and height of a chunk in tiles */
+
+	unsigned char tiles[size * size]; /* Row-major Tile values, x + y * size */
+};
+
+/*
+One immutable version of a grid, made of shared chunks.
+Consecutive versions share every chunk that wasn't edited in between.
+Satisfies the map interface MapAStarSearch expects.
+*/
+class GridSnapshot {
+public:
+	int GetGridX() const; /* Returns the grid's width */
+	int GetGridY() const; /* Returns the grid's height */
+	Tile GetTile(int x, int y) const; /* Returns the tile at (x, y), or a wall if out of bounds */
+	bool IsWalkable(int x, int y) const; /* Returns true if (x, y) is in bounds and a floor tile */
+	Cell GetStartPos() const; /* Returns the start position of this version */
+	Cell GetGoalPos() const; /* Returns the goal position of this version */
+	unsigned long long GetVersion() const; /* Returns the version number, which increases with every publish */
+private:
+	friend class VersionedGrid;
+
+	int width = 0;
+	int height = 0;
+	int chunksX = 0; /* Chunks per row */
+	Cell startPos;
+	Cell goalPos;
+	unsigned long long version = 0;
+	std::vector<std::shared_ptr<GridChunk>> chunks; /* Row-major, chunk (cx, cy) at cx + cy * chunksX */
+};
+
+class VersionedGrid;
+
+/*
+Keeps a snapshot alive while a reader uses it. Movable, not copyable.
+Pinning never blocks writers and never takes a lock.
+*/
+class PinnedSnapshot {
+public:
+	PinnedSnapshot(); /* An empty pin */
+	PinnedSnapshot(PinnedSnapshot &&other);
+	PinnedSnapshot &operator=(PinnedSnapshot &&other);
+	~PinnedSnapshot(); /* Releases the pin */
+
+	const GridSnapshot &operator*() const; /* The pinned snapshot */
+	const GridSnapshot *operator->() const; /* The pinned snapshot */
+	const GridSnapshot *Get() const; /* The pinned snapshot, nullptr if empty */
+	void Release(); /* Releases the pin early. The snapshot must not be used afterwards */
+private:
+	friend class VersionedGrid;
+	PinnedSnapshot(const PinnedSnapshot &) = delete;
+	PinnedSnapshot &operator=(const PinnedSnapshot &) = delete;
+
+	VersionedGrid *owner = nullptr;
+	const GridSnapshot *snapshot = nullptr;
+	int slot = -1; /* The reader slot holding this pin's epoch */
+};
+
+/*
+A grid that readers can search while writers keep editing it.
+Every edit publishes a new GridSnapshot, copying only the chunks it touched.
+Readers Pin the current snapshot and see one consistent version for as long as they hold it.
+Old snapshots are reclaimed with epochs: a snapshot retired in epoch e is freed once every pinned reader entered after e.
+Writers are serialized with each other, readers never wait.
+*/
+class VersionedGrid {
+public:
+	static const int maxReaders = 64; /* Pins that may be held at once. Pin spins while all are taken */
+
+	VersionedGrid(Grid &grid); /* Starts from a copy of grid's tiles, start and goal */
+	~VersionedGrid(); /* Frees every snapshot. No pins may still be held */
+
+	PinnedSnapshot Pin(); /* Pins the current snapshot */
+	unsigned long long GetVersion(); /* Returns the version of the current snapshot */
+
+	bool SetCell(int x, int y, Tile tile); /* Publishes a version with one cell changed. Returns false if out of bounds */
+	int ApplyEdits(const std::vector<CellEdit> &edits); /* Publishes one version with every in-bounds edit applied. Returns how many were applied */
+	void PepperWalls(); /* Publishes a version with the same random walls Grid::PepperWalls would place */
+	bool SetStartPos(int x, int y); /* Publishes a version with a new start position. Returns false if out of bounds */
+	bool SetGoalPos(int x, int y); /* Publishes a version with a new goal position. Returns false if out of bounds */
+
+	int GetRetiredCount(); /* Returns how many old snapshots are still waiting for readers to move on */
+private:
+	friend class PinnedSnapshot;
+
+	/* One reader's announced epoch, padded so readers don't share cache lines */
+	class ReaderSlot {
+	public:
+		std::atomic<unsigned long long> epoch{ 0 }; /* 0 while the slot is free */
+		char padding[64 - sizeof(std::atomic<unsigned long long>)];
+	};
+
+	/* A replaced snapshot and the epoch it was replaced in */
+	class RetiredSnapshot {
+	public:
+		GridSnapshot *snapshot;
+		unsigned long long epoch;
+	};
+
+	GridSnapshot *CopySnapshot(); /* Copies the current snapshot's chunk table, sharing every chunk */
+	unsigned char *GetWritableTile(GridSnapshot *snapshot, std::vector<bool> &copiedChunks, int x, int y); /* Copies the chunk holding (x, y) on first write */
+	void Publish(GridSnapshot *snapshot); /* Makes snapshot current and retires the previous one */
+	void Reclaim(); /* Frees retired snapshots no reader can still hold */
+	void Unpin(int slot);
+
+	std::atomic<GridSnapshot *> current{ nullptr };
+	std::atomic<unsigned long long> globalEpoch{ 1 };
+	ReaderSlot readers[maxReaders];
+
+	std::mutex writerMutex; /* Serializes writers, guards retired */
+	std::vector<RetiredSnapshot> retired;
+};
+
+#endif